@@ -0,0 +1,26 @@
+#include "awg_waveforms.h"
+
+/**********************************************************************
+ * Tablas AWG predefinidas (calculadas en compilacion)
+ **********************************************************************/
+constexpr AwgWave AWG_SQUARE_25 = awg_square(25);
+constexpr AwgWave AWG_SQUARE_50 = awg_square(50);
+constexpr AwgWave AWG_SQUARE_75 = awg_square(75);
+constexpr AwgWave AWG_TRIANGLE  = awg_triangle();
+constexpr AwgWave AWG_SAWTOOTH  = awg_sawtooth();
+
+// comprobaciones en compilacion
+static_assert(awg_in_range(AWG_SQUARE_50) && awg_in_range(AWG_TRIANGLE)
+              && awg_in_range(AWG_SAWTOOTH), "muestra AWG fuera de rango");
+static_assert(AWG_SQUARE_25.sample[DdsAwgCore::TABLE_SIZE / 4 - 1] == DdsAwgCore::DAC_MAX
+              && AWG_SQUARE_25.sample[DdsAwgCore::TABLE_SIZE / 4] == 0,
+              "flanco de la cuadrada 25% mal situado");
+static_assert(AWG_SQUARE_50.sample[DdsAwgCore::TABLE_SIZE / 2 - 1] == DdsAwgCore::DAC_MAX
+              && AWG_SQUARE_50.sample[DdsAwgCore::TABLE_SIZE / 2] == 0,
+              "flanco de la cuadrada 50% mal situado");
+static_assert(AWG_TRIANGLE.sample[0] == 0
+              && AWG_TRIANGLE.sample[DdsAwgCore::TABLE_SIZE / 2] == DdsAwgCore::DAC_MAX,
+              "extremos de la triangular incorrectos");
+static_assert(AWG_SAWTOOTH.sample[0] == 0
+              && AWG_SAWTOOTH.sample[DdsAwgCore::TABLE_SIZE - 1] < DdsAwgCore::DAC_MAX,
+              "extremos del diente de sierra incorrectos");
@@ -0,0 +1,78 @@
+#ifndef _AWG_WAVEFORMS_H_INCLUDED
+#define _AWG_WAVEFORMS_H_INCLUDED
+#include "dds_awg_core.h"
+
+/**********************************************************************
+ * Biblioteca de formas de onda AWG generadas en compilacion
+ *  - cada tabla es un array de DdsAwgCore::TABLE_SIZE muestras de
+ *    DdsAwgCore::DAC_WIDTH bits (0..DAC_MAX), calculado con constexpr
+ *  - las tablas predefinidas van en memoria de solo lectura
+ *    (awg_waveforms.cpp); cargar una forma de onda solo cuesta las
+ *    escrituras en el bus (DdsAwgCore::load_awg_table)
+ *  - se pueden crear tablas propias en compilacion, p.ej.:
+ *      constexpr AwgWave sq25 = awg_square(25);
+ *  - los generadores son constexpr con bucles: requieren C++14
+ **********************************************************************/
+
+/**
+ * tabla AWG completa (una muestra por posicion de la RAM).
+ */
+struct AwgWave {
+   uint16_t sample[DdsAwgCore::TABLE_SIZE];
+};
+
+/**
+ * onda cuadrada.
+ * @param duty ciclo de trabajo en porcentaje (0-100)
+ */
+constexpr AwgWave awg_square(int duty) {
+   AwgWave w = {};
+   int threshold = (DdsAwgCore::TABLE_SIZE * duty) / 100;
+   for (int i = 0; i < DdsAwgCore::TABLE_SIZE; i++)
+      w.sample[i] = (i < threshold) ? DdsAwgCore::DAC_MAX : 0;
+   return w;
+}
+
+/**
+ * onda triangular (0 -> DAC_MAX -> 0).
+ */
+constexpr AwgWave awg_triangle() {
+   AwgWave w = {};
+   int half = DdsAwgCore::TABLE_SIZE / 2;
+   for (int i = 0; i < DdsAwgCore::TABLE_SIZE; i++) {
+      if (i < half)
+         w.sample[i] = (DdsAwgCore::DAC_MAX * i) / half;
+      else
+         w.sample[i] = (DdsAwgCore::DAC_MAX * (DdsAwgCore::TABLE_SIZE - i)) / half;
+   }
+   return w;
+}
+
+/**
+ * onda diente de sierra (rampa ascendente).
+ */
+constexpr AwgWave awg_sawtooth() {
+   AwgWave w = {};
+   for (int i = 0; i < DdsAwgCore::TABLE_SIZE; i++)
+      w.sample[i] = (DdsAwgCore::DAC_MAX * i) / DdsAwgCore::TABLE_SIZE;
+   return w;
+}
+
+/**
+ * comprueba en compilacion que todas las muestras caben en el DAC.
+ */
+constexpr bool awg_in_range(const AwgWave &w) {
+   for (int i = 0; i < DdsAwgCore::TABLE_SIZE; i++)
+      if (w.sample[i] > DdsAwgCore::DAC_MAX)
+         return false;
+   return true;
+}
+
+/* tablas predefinidas (ROM) */
+extern const AwgWave AWG_SQUARE_25;
+extern const AwgWave AWG_SQUARE_50;
+extern const AwgWave AWG_SQUARE_75;
+extern const AwgWave AWG_TRIANGLE;
+extern const AwgWave AWG_SAWTOOTH;
+
+#endif  // _AWG_WAVEFORMS_H_INCLUDED
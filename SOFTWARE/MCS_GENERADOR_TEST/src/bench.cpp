@@ -0,0 +1,62 @@
+#include "bench.h"
+#include "uart_core.h"
+
+static uint32_t bench_ovh = 0;
+static BenchResult bench_cal = {"overhead", 0, 0, 0, 0};
+
+static void bench_empty(void *arg) {
+   (void) arg;
+}
+
+uint32_t bench_calibrate() {
+   bench_ovh = 0;
+   bench_run("overhead", bench_empty, 0, 32, &bench_cal);
+   bench_ovh = bench_cal.min;
+   return (bench_ovh);
+}
+
+uint32_t bench_overhead() {
+   return (bench_ovh);
+}
+
+void bench_run(const char *name, BenchFn fn, void *arg, int n, BenchResult *r) {
+   uint32_t t0, t;
+   int i;
+
+   r->name = name;
+   r->n = 0;
+   r->min = 0xFFFFFFFF;
+   r->max = 0;
+   r->sum = 0;
+   for (i = 0; i < n; i++) {
+      t0 = now_tick32();
+      fn(arg);
+      t = now_tick32() - t0;
+      t = (t > bench_ovh) ? t - bench_ovh : 0;
+      if (t < r->min)
+         r->min = t;
+      if (t > r->max)
+         r->max = t;
+      r->sum += t;
+      r->n++;
+   }
+}
+
+void bench_report_header(UartCore *uart_p) {
+   uart_p->disp("bench,nombre,n,min,medio,max\n\r");
+   bench_report(uart_p, &bench_cal);
+}
+
+void bench_report(UartCore *uart_p, const BenchResult *r) {
+   uart_p->disp("bench,");
+   uart_p->disp(r->name);
+   uart_p->disp(",");
+   uart_p->disp((int) r->n);
+   uart_p->disp(",");
+   uart_p->disp((int) r->min);
+   uart_p->disp(",");
+   uart_p->disp((int) (r->n ? r->sum / r->n : 0));
+   uart_p->disp(",");
+   uart_p->disp((int) r->max);
+   uart_p->disp("\n\r");
+}
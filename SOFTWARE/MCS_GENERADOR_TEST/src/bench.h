@@ -0,0 +1,74 @@
+#ifndef _BENCH_H_INCLUDED
+#define _BENCH_H_INCLUDED
+#include "init.h"
+
+class UartCore;
+
+/**********************************************************************
+ * bench: micro-benchmarks en ciclos de SYS_CLK_FREQ
+ *  - bench_run() ejecuta n veces una funcion y guarda min/medio/max
+ *  - cada muestra se mide con now_tick32() (un acceso al bus) y se le
+ *    resta el coste fijo de la medida (lectura del timer + llamada
+ *    indirecta), calibrado con bench_calibrate() sobre una funcion vacia
+ *  - bench_report() imprime una linea CSV por resultado para poder
+ *    compararlos entre versiones:
+ *       bench,<nombre>,<n>,<min>,<medio>,<max>
+ *    (ciclos; la fila bench,overhead,... es la calibracion, sin restar,
+ *    y su min es lo que se resta a las demas)
+ *  - intervalos < 2^31 ticks por muestra (17 s)
+ *
+ * Ejemplo:
+ *    BenchResult r;
+ *    bench_calibrate();
+ *    bench_run("dds_set_fcw", set_fcw_fn, &dds, 64, &r);
+ *    bench_report_header(&uart);
+ *    bench_report(&uart, &r);
+ **********************************************************************/
+
+typedef void (*BenchFn)(void *arg);
+
+struct BenchResult {
+   const char *name;   // literal
+   uint32_t n;         // muestras
+   uint32_t min;       // ciclos, sin el coste de medida
+   uint32_t max;
+   uint64_t sum;
+};
+
+/**
+ * mide el coste fijo de una muestra (minimo de varias sobre una funcion
+ * vacia) y lo resta en los bench_run() siguientes.
+ * @return coste en ciclos
+ */
+uint32_t bench_calibrate();
+
+/**
+ * coste fijo de medida en uso.
+ * @return ciclos restados a cada muestra
+ */
+uint32_t bench_overhead();
+
+/**
+ * ejecuta fn(arg) n veces y mide cada llamada.
+ * @param name nombre del resultado (literal)
+ * @param fn funcion a medir
+ * @param arg argumento de fn
+ * @param n # muestras (> 0)
+ * @param r resultado
+ */
+void bench_run(const char *name, BenchFn fn, void *arg, int n, BenchResult *r);
+
+/**
+ * imprime la cabecera CSV y la fila "overhead" de la calibracion.
+ * @param uart_p uart de salida
+ */
+void bench_report_header(UartCore *uart_p);
+
+/**
+ * imprime un resultado como linea CSV.
+ * @param uart_p uart de salida
+ * @param r resultado
+ */
+void bench_report(UartCore *uart_p, const BenchResult *r);
+
+#endif // _BENCH_H_INCLUDED
@@ -0,0 +1,584 @@
+#include "bench_suite.h"
+
+#ifdef _BENCH
+
+#include "uart_core.h"
+#include "spi_core.h"
+#include "dds_awg_core.h"
+#include "awg_waveforms.h"
+#include "wave_store.h"
+#include "trace.h"
+
+static const int MAX_RESULTS = 64;
+static BenchResult res[MAX_RESULTS];
+static int num_res = 0;
+static volatile uint32_t sink;   // resultados que el compilador no puede quitar
+static int seq = 0;              // entrada variable de las funciones medidas
+
+// siguiente resultado libre (el ultimo se reutiliza si no caben)
+static BenchResult *next_result() {
+   if (num_res < MAX_RESULTS)
+      num_res++;
+   return &res[num_res - 1];
+}
+
+static void run(const char *name, BenchFn fn, void *arg, int n) {
+   bench_run(name, fn, arg, n, next_result());
+}
+
+/*******************************************************************
+ * Sintonia DDS: retune completo con la ruta double (set_freq,
+ * soft-float) frente a la entera (set_freq_uhz), y solo el calculo
+ * del FCW en cada ruta.
+ *******************************************************************/
+static void b_set_freq(void *arg) {
+   ((DdsAwgCore *) arg)->set_freq(1000.0 + 1234.567 * (seq++ & 63));
+}
+
+static void b_set_freq_uhz(void *arg) {
+   ((DdsAwgCore *) arg)->set_freq_uhz(1000000000ULL + 1234567000ULL * (seq++ & 63));
+}
+
+static void b_fcw_double(void *arg) {
+   (void) arg;
+   sink = (uint32_t) ((1000.0 + 1234.567 * (seq++ & 63)) * 4294967296.0
+                      / (DDS_SAMPLE_FREQ * 1000000.0));
+}
+
+static void b_fcw_uhz(void *arg) {
+   (void) arg;
+   sink = DdsFreqMicroHz::to_word(1000000000ULL + 1234567000ULL * (seq++ & 63));
+}
+
+static void dds_tuning_bench(DdsAwgCore *dds_p) {
+   run("dds_set_freq", b_set_freq, dds_p, 64);
+   run("dds_set_freq_uhz", b_set_freq_uhz, dds_p, 64);
+   run("fcw_calc_double", b_fcw_double, 0, 64);
+   run("fcw_calc_uhz", b_fcw_uhz, 0, 64);
+}
+
+/*******************************************************************
+ * Carga de tabla AWG: TABLE_SIZE muestras con escrituras sueltas
+ * (RAM_ADDR + RAM_DATA por muestra) frente a la rafaga (auto-incremento
+ * + pares empaquetados) y a load_awg_table() (rafaga + CRC + banco).
+ *******************************************************************/
+static void b_awg_single(void *arg) {
+   for (int i = 0; i < DdsAwgCore::TABLE_SIZE; i++)
+      ((DdsAwgCore *) arg)->write_awg_sample(i, AWG_TRIANGLE.sample[i]);
+}
+
+static void b_awg_burst(void *arg) {
+   ((DdsAwgCore *) arg)->load_awg_burst(AWG_TRIANGLE.sample, 0, DdsAwgCore::TABLE_SIZE);
+}
+
+static void b_awg_load(void *arg) {
+   ((DdsAwgCore *) arg)->load_awg_table(AWG_TRIANGLE.sample);
+}
+
+static void awg_upload_bench(DdsAwgCore *dds_p) {
+   run("awg_write_sample_x1024", b_awg_single, dds_p, 4);
+   run("awg_load_burst", b_awg_burst, dds_p, 4);
+   run("awg_load_table", b_awg_load, dds_p, 8);
+}
+
+/*******************************************************************
+ * Retune: desde set_fcw() hasta que el hardware confirma el COMMIT
+ * (STATUS.update_done) en cada modo. La salida cambia 3 ciclos de
+ * clk_dds despues (pipeline).
+ *******************************************************************/
+static void b_retune(void *arg) {
+   DdsAwgCore *dds_p = (DdsAwgCore *) arg;
+
+   dds_p->set_fcw(0x01000000 + ((seq++ & 31) << 16));
+   dds_p->wait_applied();
+}
+
+static void dds_retune_bench(DdsAwgCore *dds_p) {
+   static const char *const name[3] = {
+      "dds_retune_continuous", "dds_retune_restart", "dds_retune_disable"
+   };
+   int mode;
+
+   dds_p->select_wave(0);
+   dds_p->enable(true);
+   for (mode = DdsAwgCore::RETUNE_CONTINUOUS; mode <= DdsAwgCore::RETUNE_DISABLE; mode++) {
+      dds_p->set_retune_mode(mode);
+      run(name[mode], b_retune, dds_p, 32);
+   }
+   dds_p->set_retune_mode(DdsAwgCore::RETUNE_CONTINUOUS);
+   dds_p->enable(false);
+}
+
+/*******************************************************************
+ * Edicion en vivo de la tabla AWG: 32 muestras de la triangular
+ * cambiadas, carga completa frente a la actualizacion incremental
+ * (copia sombra + tramos modificados). La incremental alterna entre
+ * las dos tablas para que cada llamada tenga 32 cambios.
+ *******************************************************************/
+static uint16_t awg_shadow[DdsAwgCore::TABLE_SIZE];
+static uint16_t awg_edit[DdsAwgCore::TABLE_SIZE];
+
+static void b_awg_full_edit(void *arg) {
+   ((DdsAwgCore *) arg)->load_awg_table(awg_edit);
+}
+
+static void b_awg_incr(void *arg) {
+   ((DdsAwgCore *) arg)->update_awg_table((seq++ & 1) ? AWG_TRIANGLE.sample : awg_edit);
+}
+
+static void awg_update_bench(DdsAwgCore *dds_p) {
+   int i;
+
+   for (i = 0; i < DdsAwgCore::TABLE_SIZE; i++)
+      awg_edit[i] = AWG_TRIANGLE.sample[i];
+   for (i = 100; i < 132; i++)
+      awg_edit[i] = DdsAwgCore::DAC_MAX / 2;
+   dds_p->attach_awg_shadow(awg_shadow);
+   run("awg_edit32_full", b_awg_full_edit, dds_p, 8);
+   dds_p->load_awg_table(AWG_TRIANGLE.sample);   // sombra = triangular
+   seq = 0;
+   run("awg_edit32_incr", b_awg_incr, dds_p, 8);
+   dds_p->attach_awg_shadow(0);
+}
+
+/*******************************************************************
+ * Formateo de numeros (sin transmitir): el formateador anterior (% y /
+ * por digito) frente a UartCore::format_int() (reciproco + pares de
+ * digitos), y disp(double, 3) frente a disp_fixed() con el mismo valor.
+ *******************************************************************/
+static void fmt_int_legacy(char *buf, int n, int base) {
+   char tmp[33];
+   char *str;
+   int rem;
+   unsigned int un;
+
+   un = (base == 10 && n < 0) ? (unsigned) -n : (unsigned) n;
+   str = &tmp[32];
+   *str = '\0';
+   do {
+      rem = un % base;
+      un = un / base;
+      *--str = (rem < 10) ? (char) rem + '0' : (char) rem - 10 + 'a';
+   } while (un);
+   if (base == 10 && n < 0)
+      *--str = '-';
+   while ((*buf++ = *str++)) {
+   }
+}
+
+static const int fmt_val[4] = {7, -4096, 165000000, -2147483647};
+
+static void b_fmt_legacy(void *arg) {
+   char buf[UartCore::FMT_BUF_SIZE];
+
+   (void) arg;
+   fmt_int_legacy(buf, fmt_val[seq++ & 3], 10);
+}
+
+static void b_fmt_int(void *arg) {
+   char buf[UartCore::FMT_BUF_SIZE];
+
+   (void) arg;
+   UartCore::format_int(buf, fmt_val[seq++ & 3], 10, 0);
+}
+
+static void b_disp_double(void *arg) {
+   ((UartCore *) arg)->disp(-3.141, 3);
+}
+
+static void b_disp_fixed(void *arg) {
+   ((UartCore *) arg)->disp_fixed(-3141, 3);
+}
+
+static void uart_fmt_bench(UartCore *uart_p) {
+   run("fmt_int_legacy", b_fmt_legacy, 0, 64);
+   run("fmt_int", b_fmt_int, 0, 64);
+   // transmision retenida: se mide el formateo + encolado en el ring
+   // (8 x 6 bytes caben) y se descarta, asi no sale por la uart del informe
+   uart_p->flush();
+   uart_p->set_tx_hold(true);
+   run("uart_disp_double", b_disp_double, uart_p, 8);
+   uart_p->tx_discard();
+   run("uart_disp_fixed", b_disp_fixed, uart_p, 8);
+   uart_p->tx_discard();
+   uart_p->set_tx_hold(false);
+}
+
+/*******************************************************************
+ * Lectura del tiempo: now_us() con la division de 64 bits anterior
+ * (rutina de libgcc) y con la actual (reciproco), y now_tick32().
+ *******************************************************************/
+static void b_now_us_div(void *arg) {
+   (void) arg;
+   sink = (uint32_t) (now_tick() / SYS_CLK_FREQ);
+}
+
+static void b_now_us(void *arg) {
+   (void) arg;
+   sink = (uint32_t) now_us();
+}
+
+static void b_now_tick32(void *arg) {
+   (void) arg;
+   sink = now_tick32();
+}
+
+static void timer_bench() {
+   run("now_us_div", b_now_us_div, 0, 64);
+   run("now_us", b_now_us, 0, 64);
+   run("now_tick32", b_now_tick32, 0, 64);
+}
+
+/*******************************************************************
+ * Alarma periodica: canal 0 cada 100 us y un bucle que solo lee STAT0
+ * (poll_alarm). El resultado es el retraso de deteccion sobre el tick
+ * de disparo ideal (sin restar el coste de medida: es una latencia);
+ * los disparos perdidos (overrun) y las lecturas de STAT se imprimen
+ * aparte.
+ *******************************************************************/
+static int alarm_ovr = 0;
+static uint32_t alarm_polls = 0;
+
+static void timer_alarm_bench() {
+   const int N = 1000;
+   const uint32_t PERIOD = 100 * SYS_CLK_FREQ;   // 100 us
+   TimerCore *tmr = sys_timer();
+   BenchResult *r = next_result();
+   uint32_t due, late;
+   int i, st;
+
+   r->name = "timer_alarm_late_100us";
+   r->n = 0;
+   r->min = 0xFFFFFFFF;
+   r->max = 0;
+   r->sum = 0;
+   due = tmr->set_periodic(0, PERIOD);
+   for (i = 0; i < N; i++) {
+      while ((st = tmr->poll_alarm(0)) == TimerCore::ALARM_NONE)
+         alarm_polls++;
+      late = tmr->read_tick32() - due;
+      if (st == TimerCore::ALARM_OVERRUN)
+         alarm_ovr++;
+      due += PERIOD;
+      if (late >= PERIOD)   // disparo perdido: ya contado como overrun
+         continue;
+      if (late < r->min)
+         r->min = late;
+      if (late > r->max)
+         r->max = late;
+      r->sum += late;
+      r->n++;
+   }
+   tmr->cancel_alarm(0);
+}
+
+/*******************************************************************
+ * Throughput SPI: 256 bytes por byte (driver anterior, sin FIFOs) y en
+ * rafaga (transfer/write/read) a varias frecuencias de sclk. El
+ * informe anade una tabla en KB/s (1 KB = 1000 bytes):
+ * 256 * SYS_CLK_FREQ * 1000 / ciclos medios, junto al limite del
+ * enlace f_sclk / 8 con el sclk real (dvsr entero).
+ *******************************************************************/
+static const int SPI_N = 256;
+static const int SPI_NF = 3;
+static uint8_t spi_buf[SPI_N];
+static int spi_res0 = -1;              // primer resultado (4 por frecuencia)
+static uint32_t spi_sclk_khz[SPI_NF];  // sclk real de cada frecuencia
+
+// transferencia por byte del driver anterior: espera ready, escribe,
+// espera ready y lee
+static uint8_t spi_transfer_legacy(uint32_t base, uint8_t data) {
+   while (!(io_read(base, SpiCore::RD_DATA_REG) & SpiCore::READY_FIELD)) {}
+   io_write(base, SpiCore::WR_DATA_REG, (uint32_t) data);
+   while (!(io_read(base, SpiCore::RD_DATA_REG) & SpiCore::READY_FIELD)) {}
+   return ((uint8_t) io_read(base, SpiCore::RX_POP_REG));
+}
+
+static void b_spi_legacy(void *arg) {
+   (void) arg;
+   for (int i = 0; i < SPI_N; i++)
+      spi_buf[i] = spi_transfer_legacy(get_slot_addr(BRIDGE_BASE, S4_SPI), spi_buf[i]);
+}
+
+static void b_spi_transfer256(void *arg) {
+   ((SpiCore *) arg)->transfer(spi_buf, spi_buf, SPI_N);
+}
+
+static void b_spi_write256(void *arg) {
+   ((SpiCore *) arg)->write(spi_buf, SPI_N);
+}
+
+static void b_spi_read256(void *arg) {
+   ((SpiCore *) arg)->read(spi_buf, SPI_N);
+}
+
+static void spi_throughput_bench(SpiCore *spi_p) {
+   static const int freq[SPI_NF] = {1000, 12500, 62500};   // KHz (62.5 MHz: dvsr=0)
+   static const char *const name[SPI_NF][4] = {
+      {"spi256_legacy_1M", "spi256_transfer_1M", "spi256_write_1M", "spi256_read_1M"},
+      {"spi256_legacy_12M5", "spi256_transfer_12M5", "spi256_write_12M5", "spi256_read_12M5"},
+      {"spi256_legacy_62M5", "spi256_transfer_62M5", "spi256_write_62M5", "spi256_read_62M5"}
+   };
+   int f, i, dvsr;
+
+   for (i = 0; i < SPI_N; i++)
+      spi_buf[i] = (uint8_t) i;
+   spi_p->set_mode(0, 0);
+   spi_res0 = num_res;
+   for (f = 0; f < SPI_NF; f++) {
+      spi_p->set_freq(freq[f]);
+      // mismo redondeo que SpiCore::set_freq()
+      dvsr = (SYS_CLK_FREQ * 1000) / (2 * freq[f]) - 1;
+      if (dvsr < 0)
+         dvsr = 0;
+      spi_sclk_khz[f] = SYS_CLK_FREQ * 1000 / (2 * (dvsr + 1));
+      spi_p->assert_ss(0);
+      run(name[f][0], b_spi_legacy, 0, 4);
+      run(name[f][1], b_spi_transfer256, spi_p, 4);
+      run(name[f][2], b_spi_write256, spi_p, 4);
+      run(name[f][3], b_spi_read256, spi_p, 4);
+      spi_p->deassert_ss(0);
+   }
+}
+
+// tabla de throughput: spi_kbs,<nombre>,<sclk KHz>,<KB/s>,<limite KB/s>
+static void spi_throughput_report(UartCore *uart_p) {
+   const BenchResult *r;
+   uint32_t avg;
+   int f, k;
+
+   if (spi_res0 < 0)
+      return;
+   uart_p->disp("spi_kbs,nombre,sclk_khz,kb_s,limite_kb_s\n\r");
+   for (f = 0; f < SPI_NF; f++) {
+      for (k = 0; k < 4; k++) {
+         r = &res[spi_res0 + 4 * f + k];
+         avg = r->n ? (uint32_t) (r->sum / r->n) : 0;
+         uart_p->disp("spi_kbs,");
+         uart_p->disp(r->name);
+         uart_p->disp(",");
+         uart_p->disp((int) spi_sclk_khz[f]);
+         uart_p->disp(",");
+         uart_p->disp(avg ? (int) ((uint64_t) SPI_N * SYS_CLK_FREQ * 1000 / avg) : 0);
+         uart_p->disp(",");
+         uart_p->disp((int) (spi_sclk_khz[f] / 8));
+         uart_p->disp("\n\r");
+      }
+   }
+}
+
+/*******************************************************************
+ * Solape SPI: FCW de 32 bits (barrido calculado con DdsFreqMicroHz)
+ * enviados a 12.5 MHz esperando cada palabra (start y finish seguidos)
+ * y calculando la siguiente mientras se desplaza la actual. El
+ * desplazamiento solo son 32 x 2(dvsr+1) = 320 ciclos.
+ *******************************************************************/
+struct SpiOverlap {
+   SpiCore *spi_p;
+   uint32_t w;   // palabra ya calculada (solapado)
+};
+
+static const uint64_t SWEEP_F0 = 1000000000ULL;   // 1 KHz en uHz
+static const uint64_t SWEEP_DF = 12345678ULL;     // ~12.3 Hz por paso
+
+static void b_fcw_step(void *arg) {
+   (void) arg;
+   sink = DdsFreqMicroHz::to_word(SWEEP_F0 + (seq++ & 63) * SWEEP_DF);
+}
+
+static void b_spi_seq(void *arg) {
+   SpiCore *spi_p = ((SpiOverlap *) arg)->spi_p;
+
+   spi_p->start(DdsFreqMicroHz::to_word(SWEEP_F0 + (seq++ & 63) * SWEEP_DF));
+   spi_p->finish();
+}
+
+static void b_spi_overlap(void *arg) {
+   SpiOverlap *o = (SpiOverlap *) arg;
+
+   o->spi_p->start(o->w);
+   o->w = DdsFreqMicroHz::to_word(SWEEP_F0 + (seq++ & 63) * SWEEP_DF);
+   o->spi_p->finish();
+}
+
+static void spi_overlap_bench(SpiCore *spi_p) {
+   SpiOverlap o;
+
+   o.spi_p = spi_p;
+   spi_p->set_freq(12500);
+   spi_p->set_width(32);
+   spi_p->assert_ss(0);
+   run("spi32_fcw_calc", b_fcw_step, 0, 64);
+   run("spi32_calc_then_shift", b_spi_seq, &o, 64);
+   o.w = DdsFreqMicroHz::to_word(SWEEP_F0);
+   run("spi32_calc_overlap", b_spi_overlap, &o, 64);
+   spi_p->deassert_ss(0);
+   spi_p->set_width(8);
+}
+
+/*******************************************************************
+ * Biblioteca de formas de onda en flash: comprueba el JEDEC ID de la
+ * flash y monta la biblioteca; si no hay flash conocida o biblioteca se
+ * salta (nunca la formatea ni la programa: eso es un paso explicito de
+ * programacion, no un efecto del arranque). Mide la carga de cada
+ * forma de onda (una fila wave_load_<nombre> por entrada del
+ * directorio, hasta WAVE_BENCH_MAX) en el banco AWG libre sin conmutar;
+ * como referencia, load_awg_bank() desde RAM.
+ *******************************************************************/
+static const int WAVE_BENCH_MAX = 8;
+static const char WAVE_ROW_PREFIX[] = "wave_load_";
+// nombres de las filas (bench_report() los imprime al final)
+static char wave_row[WAVE_BENCH_MAX][sizeof(WAVE_ROW_PREFIX) - 1 + WaveStore::NAME_LEN];
+
+struct WaveLoad {
+   WaveStore *ws_p;
+   DdsAwgCore *dds_p;
+   int idx;
+   int crc_err;
+};
+
+static void b_wave_load(void *arg) {
+   WaveLoad *w = (WaveLoad *) arg;
+
+   if (!w->ws_p->load(w->idx, w->dds_p, false))
+      w->crc_err++;
+}
+
+static void b_awg_load_bank(void *arg) {
+   DdsAwgCore *dds_p = (DdsAwgCore *) arg;
+
+   dds_p->load_awg_bank(dds_p->get_write_bank(), AWG_TRIANGLE.sample);
+}
+
+static uint32_t wave_flash_id = 0;
+static int wave_crc_err = -1;   // -1: sin biblioteca, -2: flash no detectada
+
+static void wave_store_bench(WaveStore *ws_p, SpiFlash *flash_p, DdsAwgCore *dds_p,
+                             SpiCore *spi_p) {
+   WaveLoad w;
+   WaveEntry e;
+   const char *s;
+   char *d;
+   int k;
+
+   spi_p->set_mode(0, 0);
+   spi_p->set_width(8);
+   spi_p->set_freq(25000);   // dvsr=1: 31.25 MHz
+   wave_flash_id = flash_p->read_id();
+   if (!SpiFlash::known_id(wave_flash_id)) {
+      wave_crc_err = -2;
+      return;
+   }
+   if (!ws_p->mount() || ws_p->count() == 0)
+      return;
+   w.ws_p = ws_p;
+   w.dds_p = dds_p;
+   w.crc_err = 0;
+   for (w.idx = 0; w.idx < ws_p->count() && w.idx < WAVE_BENCH_MAX; w.idx++) {
+      ws_p->get_entry(w.idx, &e);
+      d = wave_row[w.idx];
+      for (s = WAVE_ROW_PREFIX; *s != 0; s++)
+         *d++ = *s;
+      for (k = 0; k < WaveStore::NAME_LEN - 1 && e.name[k] != 0; k++)
+         *d++ = e.name[k];
+      *d = 0;
+      run(wave_row[w.idx], b_wave_load, &w, 2);
+   }
+   run("awg_load_bank_ram", b_awg_load_bank, dds_p, 4);
+   wave_crc_err = w.crc_err;
+}
+
+/*******************************************************************
+ * Drivers: accesos al bus y operaciones sueltas.
+ *******************************************************************/
+static void b_io_write(void *arg) {
+   (void) arg;
+   io_write(get_slot_addr(BRIDGE_BASE, S1_LED), 0, 0);
+}
+
+static void b_io_read(void *arg) {
+   (void) arg;
+   sink = io_read(get_slot_addr(BRIDGE_BASE, S2_SW), 0);
+}
+
+static void b_gen_square(void *arg) {
+   ((DdsAwgCore *) arg)->gen_square_wave(50);
+}
+
+static void b_gen_triangle(void *arg) {
+   ((DdsAwgCore *) arg)->gen_triangle_wave();
+}
+
+static void b_gen_sawtooth(void *arg) {
+   ((DdsAwgCore *) arg)->gen_sawtooth_wave();
+}
+
+static void b_spi_transfer(void *arg) {
+   ((SpiCore *) arg)->transfer(0xA5);
+}
+
+static void b_uart_disp(void *arg) {
+   ((UartCore *) arg)->disp(-12345);
+}
+
+static void driver_bench(DdsAwgCore *dds_p, SpiCore *spi_p, UartCore *uart_p) {
+   run("io_write", b_io_write, 0, 64);
+   run("io_read", b_io_read, 0, 64);
+   run("awg_gen_square", b_gen_square, dds_p, 8);
+   run("awg_gen_triangle", b_gen_triangle, dds_p, 8);
+   run("awg_gen_sawtooth", b_gen_sawtooth, dds_p, 8);
+   spi_p->set_freq(1000);
+   spi_p->assert_ss(0);
+   run("spi_transfer", b_spi_transfer, spi_p, 16);
+   spi_p->deassert_ss(0);
+   // 16 x 6 bytes caben en el ring TX retenido; se descartan
+   uart_p->flush();
+   uart_p->set_tx_hold(true);
+   run("uart_disp_int", b_uart_disp, uart_p, 16);
+   uart_p->tx_discard();
+   uart_p->set_tx_hold(false);
+}
+
+void bench_suite(DdsAwgCore *dds_p, SpiCore *spi_p, SpiFlash *flash_p, WaveStore *ws_p,
+                 UartCore *uart_p) {
+   int i;
+
+   trace(TRACE_APP, "bench start", 0, 0);
+   num_res = 0;
+   bench_calibrate();
+   dds_tuning_bench(dds_p);
+   awg_upload_bench(dds_p);
+   dds_retune_bench(dds_p);
+   awg_update_bench(dds_p);
+   uart_fmt_bench(uart_p);
+   timer_bench();
+   timer_alarm_bench();
+   spi_throughput_bench(spi_p);
+   spi_overlap_bench(spi_p);
+   wave_store_bench(ws_p, flash_p, dds_p, spi_p);
+   driver_bench(dds_p, spi_p, uart_p);
+   trace(TRACE_APP, "bench end", num_res, 0);
+
+   bench_report_header(uart_p);
+   for (i = 0; i < num_res; i++)
+      bench_report(uart_p, &res[i]);
+   spi_throughput_report(uart_p);
+   uart_p->disp("alarma: overruns ");
+   uart_p->disp(alarm_ovr);
+   uart_p->disp(", lecturas de STAT ");
+   uart_p->disp((int) alarm_polls);
+   uart_p->disp("\n\rwave store: ");
+   if (wave_crc_err == -2) {
+      uart_p->disp("flash no detectada (id 0x");
+      uart_p->disp((int) wave_flash_id, 16);
+      uart_p->disp(")");
+   } else if (wave_crc_err < 0)
+      uart_p->disp("sin biblioteca");
+   else if (wave_crc_err == 0)
+      uart_p->disp("crc ok");
+   else
+      uart_p->disp("crc ERROR");
+   uart_p->disp("\n\r");
+}
+
+#endif  // _BENCH
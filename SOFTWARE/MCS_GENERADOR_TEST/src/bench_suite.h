@@ -0,0 +1,45 @@
+#ifndef _BENCH_SUITE_H_INCLUDED
+#define _BENCH_SUITE_H_INCLUDED
+#include "bench.h"
+
+class DdsAwgCore;
+class SpiCore;
+class SpiFlash;
+class UartCore;
+class WaveStore;
+
+/**********************************************************************
+ * bench_suite: benchmarks de arranque del firmware (drivers, DDS/AWG,
+ * uart, timer, SPI y biblioteca de formas de onda)
+ *  - solo existe con _BENCH definido en todo el proyecto (-D_BENCH en
+ *    las opciones del compilador, no con un #define en un fichero): sin
+ *    _BENCH no entra en la imagen y main() no lo llama
+ *  - cada medida pasa por bench_run(); los resultados se imprimen al
+ *    final con bench_report(), una linea CSV por operacion, asi la uart
+ *    no interfiere con las medidas
+ *  - deja los cores como los encuentra (DDS parado, SPI en 8 bits)
+ *  - no escribe nunca en la flash: si su JEDEC ID no es conocido o no
+ *    hay biblioteca montable, el benchmark de WaveStore se salta
+ *  - compila tambien en el host contra el bus simulado (test/Makefile,
+ *    -D_HOST_IO): alli los ciclos son accesos al bus
+ *
+ * Ejemplo (main.cpp):
+ *    #ifdef _BENCH
+ *    bench_suite(&dds, &spi, &flash, &wstore, &uart);
+ *    #endif
+ **********************************************************************/
+
+#ifdef _BENCH
+/**
+ * ejecuta todos los benchmarks y los imprime por uart.
+ * @param dds_p canal DDS (se usa su banco de escritura)
+ * @param spi_p SpiCore (ss 0 libre, flash de ws_p en su ss)
+ * @param flash_p flash de la biblioteca (solo read_id())
+ * @param ws_p biblioteca de formas de onda en flash
+ * @param uart_p uart de salida
+ */
+void bench_suite(DdsAwgCore *dds_p, SpiCore *spi_p, SpiFlash *flash_p, WaveStore *ws_p,
+                 UartCore *uart_p);
+#endif  // _BENCH
+
+#endif  // _BENCH_SUITE_H_INCLUDED
@@ -1,5 +1,35 @@
 
 #include "dds_awg_core.h"
+#include "awg_waveforms.h"
+#include "trace.h"
+
+/**********************************************************************
+ * Tabla CRC32 (IEEE 802.3, reflejada, 0xEDB88320) en ROM
+ **********************************************************************/
+struct Crc32Table {
+   uint32_t t[256];
+};
+
+static constexpr Crc32Table crc32_table() {
+   Crc32Table tab = {};
+   for (uint32_t i = 0; i < 256; i++) {
+      uint32_t c = i;
+      for (int b = 0; b < 8; b++)
+         c = (c & 1) ? (c >> 1) ^ 0xEDB88320u : c >> 1;
+      tab.t[i] = c;
+   }
+   return tab;
+}
+
+static constexpr Crc32Table CRC32_TAB = crc32_table();
+static_assert(CRC32_TAB.t[1] == 0x77073096u, "tabla CRC32 incorrecta");
+
+// una muestra AWG: 2 bytes, little-endian
+static inline uint32_t crc32_sample(uint32_t crc, uint16_t s) {
+   crc = (crc >> 8) ^ CRC32_TAB.t[(crc ^ s) & 0xFF];
+   crc = (crc >> 8) ^ CRC32_TAB.t[(crc ^ (s >> 8)) & 0xFF];
+   return crc;
+}
 
 /**********************************************************************
  * DdsAwgCore
@@ -7,49 +37,104 @@
 DdsAwgCore::DdsAwgCore(uint32_t core_base_addr) {
    base_addr   = core_base_addr;
    ctrl_data   = 0x00000000;
+   ctrl_once   = 0;
    pow_data    = 0x00000000;
-   // inicializar registros
+   bank_wr     = 0;
+   bank_play   = 0;
+   bank_active = 0;
+   txn         = false;
+   retune_mode = RETUNE_CONTINUOUS;
+   sweep_ctrl  = 0;
+   awg_shadow  = 0;
+   shadow_bank = -1;
+   writes_saved = 0;
+   stream_pos  = 0;
+   stream_crc  = 0xFFFFFFFF;
+   // inicializar registros (con la salida deshabilitada el banco conmuta ya)
    io_write(base_addr, FCW_REG, 0);
    io_write(base_addr, CTRL_REG, ctrl_data);
    io_write(base_addr, POW_REG, 0);
+   io_write(base_addr, SWEEP_CTRL_REG, sweep_ctrl);
+   io_write(base_addr, COMMIT_REG, 0);
+   io_write(base_addr, BANK_WR_REG, bank_wr);
+   io_write(base_addr, BANK_PLAY_REG, bank_play);
 }
 
 DdsAwgCore::~DdsAwgCore() {
 }
 
-void DdsAwgCore::set_freq(double freq_hz) {
+bool DdsAwgCore::set_freq(double freq_hz) {
+   bool ok;
    bool was_on = safe_disable();
-   // Clamp a Nyquist (f_clk/2)
-   double max_freq = (DDS_CLK_FREQ * 1000000.0) / 2.0;
+   // Clamp a Nyquist (f_s/2)
+   double max_freq = (DDS_SAMPLE_FREQ * 1000000.0) / 2.0;
    if (freq_hz > max_freq) freq_hz = max_freq;
    if (freq_hz < 0.0) freq_hz = 0.0;
-   // fcw = freq_hz * 2^32 / f_clk
-   double fcw_d = freq_hz * 4294967296.0 / (DDS_CLK_FREQ * 1000000.0);
+   // fcw = freq_hz * 2^32 / f_s
+   double fcw_d = freq_hz * 4294967296.0 / (DDS_SAMPLE_FREQ * 1000000.0);
    uint32_t fcw = (uint32_t) fcw_d;
    io_write(base_addr, FCW_REG, fcw);
-   safe_restore(was_on);
+   ok = apply();
+   return safe_restore(was_on) && ok;
+}
+
+uint64_t DdsAwgCore::set_freq_mhz(uint64_t freq_mhz) {
+   uint32_t fcw;
+
+   // Clamp a Nyquist (f_s/2)
+   if (freq_mhz > DdsFreqMilliHz::FULL_SCALE / 2)
+      freq_mhz = DdsFreqMilliHz::FULL_SCALE / 2;
+   fcw = DdsFreqMilliHz::to_word(freq_mhz);
+   set_fcw(fcw);
+   return DdsFreqMilliHz::from_word(fcw);
 }
 
-void DdsAwgCore::set_fcw(uint32_t fcw) {
+uint64_t DdsAwgCore::set_freq_uhz(uint64_t freq_uhz) {
+   uint32_t fcw;
+
+   // Clamp a Nyquist (f_s/2)
+   if (freq_uhz > DdsFreqMicroHz::FULL_SCALE / 2)
+      freq_uhz = DdsFreqMicroHz::FULL_SCALE / 2;
+   fcw = DdsFreqMicroHz::to_word(freq_uhz);
+   set_fcw(fcw);
+   return DdsFreqMicroHz::from_word(fcw);
+}
+
+bool DdsAwgCore::set_fcw(uint32_t fcw) {
+   bool ok;
    bool was_on = safe_disable();
    io_write(base_addr, FCW_REG, fcw);
-   safe_restore(was_on);
+   ok = apply();
+   return safe_restore(was_on) && ok;
 }
 
-void DdsAwgCore::set_phase(double degrees) {
+bool DdsAwgCore::set_phase(double degrees) {
+   bool ok;
    bool was_on = safe_disable();
    // pow = degrees * 2^32 / 360.0
    double pow_d = degrees * 4294967296.0 / 360.0;
    pow_data = (uint32_t) pow_d;
    io_write(base_addr, POW_REG, pow_data);
-   safe_restore(was_on);
+   ok = apply();
+   return safe_restore(was_on) && ok;
+}
+
+uint32_t DdsAwgCore::set_phase_mdeg(uint32_t mdeg) {
+   uint32_t pow;
+
+   // to_word() trabaja modulo 2^32: 360000 mgrad equivale a 0
+   pow = DdsPhaseMilliDeg::to_word(mdeg);
+   set_pow(pow);
+   return (uint32_t) DdsPhaseMilliDeg::from_word(pow);
 }
 
-void DdsAwgCore::set_pow(uint32_t pow) {
+bool DdsAwgCore::set_pow(uint32_t pow) {
+   bool ok;
    bool was_on = safe_disable();
    pow_data = pow;
    io_write(base_addr, POW_REG, pow_data);
-   safe_restore(was_on);
+   ok = apply();
+   return safe_restore(was_on) && ok;
 }
 
 uint32_t DdsAwgCore::get_fcw() {
@@ -58,96 +143,474 @@ uint32_t DdsAwgCore::get_fcw() {
 
 double DdsAwgCore::get_freq() {
    uint32_t fcw = get_fcw();
-   return (double)fcw * (DDS_CLK_FREQ * 1000000.0) / 4294967296.0;
+   return (double)fcw * (DDS_SAMPLE_FREQ * 1000000.0) / 4294967296.0;
+}
+
+uint64_t DdsAwgCore::get_freq_uhz() {
+   return DdsFreqMicroHz::from_word(get_fcw());
 }
 
 double DdsAwgCore::get_phase() {
    return (double)pow_data * 360.0 / 4294967296.0;
 }
 
+uint32_t DdsAwgCore::get_phase_mdeg() {
+   return (uint32_t) DdsPhaseMilliDeg::from_word(pow_data);
+}
+
 uint32_t DdsAwgCore::get_pow() {
    return pow_data;
 }
 
-void DdsAwgCore::enable(bool on) {
+bool DdsAwgCore::enable(bool on) {
    if (on)
       bit_set(ctrl_data, 0);
    else
       bit_clear(ctrl_data, 0);
-   io_write(base_addr, CTRL_REG, ctrl_data);
+   io_write(base_addr, CTRL_REG, ctrl_data | ctrl_once);
+   return apply();
 }
 
-void DdsAwgCore::select_wave(int sel) {
+bool DdsAwgCore::select_wave(int sel) {
+   bool ok;
    bool was_on = safe_disable();
    if (sel)
       bit_set(ctrl_data, 1);
    else
       bit_clear(ctrl_data, 1);
-   io_write(base_addr, CTRL_REG, ctrl_data);
-   safe_restore(was_on);
+   io_write(base_addr, CTRL_REG, ctrl_data | ctrl_once);
+   ok = apply();
+   return safe_restore(was_on) && ok;
+}
+
+void DdsAwgCore::set_retune_mode(int mode) {
+   retune_mode = mode;
+}
+
+int DdsAwgCore::get_retune_mode() {
+   return retune_mode;
+}
+
+bool DdsAwgCore::reset_phase() {
+   // bit 2 se auto-borra en el registro sombra al hacer COMMIT
+   ctrl_once |= PHASE_RST_FIELD;
+   io_write(base_addr, CTRL_REG, ctrl_data | ctrl_once);
+   return apply();
+}
+
+void DdsAwgCore::begin() {
+   txn = true;
+}
+
+bool DdsAwgCore::commit() {
+   txn = false;
+   if (retune_mode == RETUNE_RESTART)
+      io_write(base_addr, CTRL_REG, ctrl_data | PHASE_RST_FIELD);
+   // el hardware ignora un COMMIT mientras el anterior cruza a clk_dds;
+   // si no llega a aplicarse (clk_dds parado) los registros sombra se
+   // quedan como estan y los aplica el siguiente COMMIT
+   if (!wait_applied()) {
+      trace(TRACE_DDS, "dds commit timeout", base_addr, 0);
+      return false;
+   }
+   io_write(base_addr, COMMIT_REG, 0);
+   ctrl_once = 0;
+   return true;
+}
+
+bool DdsAwgCore::commit_on_sync(bool phase_rst) {
+   uint32_t ctrl = ctrl_data | ctrl_once | SYNC_WAIT_FIELD;
+
+   txn = false;
+   if (phase_rst || retune_mode == RETUNE_RESTART)
+      ctrl |= PHASE_RST_FIELD;
+   // un COMMIT armado anterior sin SYNC del maestro no se aplica nunca
+   if (!wait_applied()) {
+      trace(TRACE_DDS, "dds commit timeout", base_addr, 1);
+      return false;
+   }
+   // bits 2 y 3 se auto-borran en el registro sombra al hacer COMMIT
+   io_write(base_addr, CTRL_REG, ctrl);
+   io_write(base_addr, COMMIT_REG, 0);
+   ctrl_once = 0;
+   return true;
+}
+
+void DdsAwgCore::sync() {
+   io_write(base_addr, SYNC_REG, 0);
+}
+
+bool DdsAwgCore::update_applied() {
+   return (io_read(base_addr, STATUS_REG) & UPDATE_DONE_FIELD) != 0;
+}
+
+bool DdsAwgCore::wait_applied() {
+   uint32_t t0 = now_tick32();
+
+   while (!update_applied()) {
+      if (now_tick32() - t0 > COMMIT_TIMEOUT_US * SYS_CLK_FREQ)
+         return false;
+   }
+   return true;
+}
+
+bool DdsAwgCore::sweep(uint32_t start_hz, uint32_t stop_hz, uint32_t duration_us, int mode) {
+   uint32_t fs, fe, span, lo, hi, step, dwell;
+   uint64_t cycles, steps, d;
+
+   // Clamp a Nyquist (f_s/2)
+   if (start_hz > DdsFreqHz::FULL_SCALE / 2)
+      start_hz = DdsFreqHz::FULL_SCALE / 2;
+   if (stop_hz > DdsFreqHz::FULL_SCALE / 2)
+      stop_hz = DdsFreqHz::FULL_SCALE / 2;
+   fs = DdsFreqHz::to_word(start_hz);
+   fe = DdsFreqHz::to_word(stop_hz);
+   // en log el escalon es proporcional al FCW: desde 0 no arrancaria
+   if (mode & SWEEP_LOG) {
+      if (fs == 0)
+         fs = 1;
+      if (fe == 0)
+         fe = 1;
+   }
+   lo = (fs < fe) ? fs : fe;
+   hi = (fs < fe) ? fe : fs;
+   // ciclos de clk_dds de un tramo (DDS_CLK_FREQ en MHz = ciclos/us)
+   cycles = (uint64_t) duration_us * DDS_CLK_FREQ;
+   if (cycles < SWEEP_MIN_DWELL)
+      cycles = SWEEP_MIN_DWELL;
+
+   if (mode & SWEEP_LOG) {
+      // (1 + r/2^16)^N = hi/lo  ->  N*r ~ ln(hi/lo) * 2^16
+      span = dds_ln_q16(hi, lo);
+   } else {
+      span = hi - lo;
+   }
+   // tantos escalones como permita el dwell minimo, sin bajar de 1 LSB
+   steps = cycles / SWEEP_MIN_DWELL;
+   if (steps > span)
+      steps = span;
+   if (steps == 0)
+      steps = 1;
+   step = (uint32_t) ((span + steps / 2) / steps);
+   if ((mode & SWEEP_LOG) && step > 0xFFFF)
+      step = 0xFFFF;
+   d = cycles / steps;
+   dwell = (d > 0xFFFFFFFFULL) ? 0xFFFFFFFF : (uint32_t) d;
+   return sweep_fcw(fs, fe, step, dwell, mode);
+}
+
+bool DdsAwgCore::sweep_fcw(uint32_t start_fcw, uint32_t stop_fcw, uint32_t step,
+                           uint32_t dwell, int mode) {
+   if (dwell < SWEEP_MIN_DWELL)
+      dwell = SWEEP_MIN_DWELL;
+   sweep_ctrl = SWEEP_RUN_FIELD | ((uint32_t) (mode & 0x3) << 1);
+   if (mode & SWEEP_LOG)
+      sweep_ctrl |= SWEEP_LOG_FIELD;
+   io_write(base_addr, SWEEP_START_REG, start_fcw);
+   io_write(base_addr, SWEEP_STEP_REG, step);
+   io_write(base_addr, SWEEP_DWELL_REG, dwell);
+   io_write(base_addr, SWEEP_STOP_REG, stop_fcw);
+   // bit 4 (Go) se auto-borra en el registro sombra al hacer COMMIT
+   io_write(base_addr, SWEEP_CTRL_REG, sweep_ctrl | SWEEP_GO_FIELD);
+   return apply();
+}
+
+bool DdsAwgCore::sweep_stop() {
+   sweep_ctrl = 0;
+   io_write(base_addr, SWEEP_CTRL_REG, sweep_ctrl);
+   return apply();
+}
+
+bool DdsAwgCore::sweep_running() {
+   return (io_read(base_addr, STATUS_REG) & SWEEP_ACTIVE_FIELD) != 0;
 }
 
 void DdsAwgCore::write_awg_sample(int addr, int data) {
+   uint16_t d = (uint16_t)(data & DAC_MAX);
+
    // 1. Escribir la direccion en RAM_ADDR_REG (offset 2)
    io_write(base_addr, RAM_ADDR_REG, (uint32_t)(addr & (TABLE_SIZE - 1)));
    // 2. Escribir el dato en RAM_DATA_REG (offset 3), lo que dispara el pulso WE
-   io_write(base_addr, RAM_DATA_REG, (uint32_t)(data & DAC_MAX));
+   io_write(base_addr, RAM_DATA_REG, (uint32_t) d);
+   shadow_store(bank_wr, addr, &d, 1);
 }
 
-void DdsAwgCore::load_awg_table(const int *table) {
-   bool was_on = safe_disable();
-   for (int i = 0; i < TABLE_SIZE; i++) {
-      write_awg_sample(i, table[i]);
+void DdsAwgCore::load_awg_burst(const uint16_t *data, int start, int count) {
+   uint32_t pair;
+   int i;
+
+   // una sola escritura de direccion; el hardware auto-incrementa
+   io_write(base_addr, RAM_ADDR_REG, (uint32_t)(start & (TABLE_SIZE - 1)));
+   for (i = 0; i + 1 < count; i += 2) {
+      pair = (uint32_t)(data[i] & DAC_MAX) | ((uint32_t)(data[i + 1] & DAC_MAX) << 16);
+      io_write(base_addr, RAM_PAIR_REG, pair);
+   }
+   if (i < count)
+      io_write(base_addr, RAM_DATA_REG, (uint32_t)(data[i] & DAC_MAX));
+   shadow_store(bank_wr, start, data, count);
+}
+
+bool DdsAwgCore::load_awg_table(const int *table) {
+   uint16_t pair[2];
+   uint32_t crc = 0xFFFFFFFF;
+
+   set_write_bank(free_bank());
+   shadow_claim(bank_wr);
+   io_write(base_addr, CRC_WR_REG, 0);
+   io_write(base_addr, RAM_ADDR_REG, 0);
+   for (int i = 0; i < TABLE_SIZE; i += 2) {
+      pair[0] = (uint16_t)(table[i] & DAC_MAX);
+      pair[1] = (uint16_t)(table[i + 1] & DAC_MAX);
+      io_write(base_addr, RAM_PAIR_REG, (uint32_t) pair[0] | ((uint32_t) pair[1] << 16));
+      shadow_store(bank_wr, i, pair, 2);
+      crc = crc32_sample(crc32_sample(crc, pair[0]), pair[1]);
+   }
+   if (io_read(base_addr, CRC_WR_REG) != ~crc) {
+      shadow_claim(-1);
+      return false;
+   }
+   return select_bank(bank_wr);
+}
+
+bool DdsAwgCore::load_awg_table(const uint16_t *table) {
+   if (!load_awg_bank(free_bank(), table))
+      return false;
+   return select_bank(bank_wr);
+}
+
+void DdsAwgCore::awg_stream_begin() {
+   set_write_bank(free_bank());
+   shadow_claim(bank_wr);
+   stream_pos = 0;
+   stream_crc = 0xFFFFFFFF;
+   io_write(base_addr, CRC_WR_REG, 0);
+   io_write(base_addr, RAM_ADDR_REG, 0);
+}
+
+void DdsAwgCore::awg_stream_pair(uint16_t s0, uint16_t s1) {
+   uint16_t pair[2];
+
+   if (stream_pos >= TABLE_SIZE)
+      return;
+   pair[0] = s0 & DAC_MAX;
+   pair[1] = s1 & DAC_MAX;
+   io_write(base_addr, RAM_PAIR_REG, (uint32_t) pair[0] | ((uint32_t) pair[1] << 16));
+   shadow_store(bank_wr, stream_pos, pair, 2);
+   stream_crc = crc32_sample(crc32_sample(stream_crc, pair[0]), pair[1]);
+   stream_pos += 2;
+}
+
+bool DdsAwgCore::awg_stream_end(bool play) {
+   bool ok;
+
+   ok = stream_pos == TABLE_SIZE && io_read(base_addr, CRC_WR_REG) == ~stream_crc;
+   if (!ok) {
+      shadow_claim(-1);  // banco a medio escribir
+      return false;
+   }
+   if (play)
+      return select_bank(bank_wr);
+   return true;
+}
+
+uint32_t DdsAwgCore::awg_stream_crc() {
+   return ~stream_crc;
+}
+
+void DdsAwgCore::attach_awg_shadow(uint16_t *buf) {
+   awg_shadow = buf;
+   shadow_bank = -1;
+}
+
+int DdsAwgCore::update_awg_table(const uint16_t *table) {
+   int i, j, k, gap, writes;
+
+   if (awg_shadow == 0 || shadow_bank != bank_play) {
+      load_awg_table(table);
+      return 0;
+   }
+   writes = 0;
+   if (bank_wr != shadow_bank) {
+      set_write_bank(shadow_bank);
+      writes++;
+   }
+   i = 0;
+   while (i < TABLE_SIZE) {
+      // inicio del siguiente tramo modificado
+      if ((table[i] & DAC_MAX) == awg_shadow[i]) {
+         i++;
+         continue;
+      }
+      // fin del tramo: se absorben huecos de hasta AWG_GAP_MERGE muestras
+      j = i + 1;
+      gap = 0;
+      for (k = j; k < TABLE_SIZE && gap <= AWG_GAP_MERGE; k++) {
+         if ((table[k] & DAC_MAX) != awg_shadow[k]) {
+            j = k + 1;
+            gap = 0;
+         } else {
+            gap++;
+         }
+      }
+      load_awg_burst(&table[i], i, j - i);
+      writes += 1 + (j - i + 1) / 2;
+      i = j;
+   }
+   writes_saved += AWG_FULL_WRITES - writes;
+   return AWG_FULL_WRITES - writes;
+}
+
+uint32_t DdsAwgCore::get_awg_writes_saved() {
+   return writes_saved;
+}
+
+void DdsAwgCore::set_write_bank(int bank) {
+   bank_wr = bank & (NUM_BANKS - 1);
+   io_write(base_addr, BANK_WR_REG, (uint32_t) bank_wr);
+}
+
+int DdsAwgCore::get_write_bank() {
+   return bank_wr;
+}
+
+bool DdsAwgCore::select_bank(int bank) {
+   if (!wait_bank_swap())
+      return false;
+   bank_play = bank & (NUM_BANKS - 1);
+   io_write(base_addr, BANK_PLAY_REG, (uint32_t) bank_play);
+   return true;
+}
+
+int DdsAwgCore::get_play_bank() {
+   return bank_play;
+}
+
+bool DdsAwgCore::bank_swap_pending() {
+   bool pending = (io_read(base_addr, STATUS_REG) & BANK_PENDING_FIELD) != 0;
+   if (!pending)
+      bank_active = bank_play;
+   return pending;
+}
+
+bool DdsAwgCore::load_awg_bank(int bank, const uint16_t *table) {
+   set_write_bank(bank);
+   shadow_claim(bank);
+   io_write(base_addr, CRC_WR_REG, 0);
+   load_awg_burst(table, 0, TABLE_SIZE);
+   if (io_read(base_addr, CRC_WR_REG) != awg_crc32(table, TABLE_SIZE)) {
+      shadow_claim(-1);  // contenido desconocido
+      return false;
+   }
+   return true;
+}
+
+uint32_t DdsAwgCore::get_awg_bank_crc(int bank) {
+   set_write_bank(bank);
+   io_write(base_addr, CRC_SCAN_REG, 0);
+   while (io_read(base_addr, STATUS_REG) & SCAN_BUSY_FIELD) {
    }
-   safe_restore(was_on);
+   return io_read(base_addr, CRC_SCAN_REG);
+}
+
+bool DdsAwgCore::verify_awg_bank(int bank, const uint16_t *table) {
+   return get_awg_bank_crc(bank) == awg_crc32(table, TABLE_SIZE);
+}
+
+uint32_t DdsAwgCore::awg_crc32(const uint16_t *data, int count) {
+   uint32_t crc = 0xFFFFFFFF;
+
+   for (int i = 0; i < count; i++)
+      crc = crc32_sample(crc, data[i] & DAC_MAX);
+   return ~crc;
 }
 
 void DdsAwgCore::gen_square_wave(int duty) {
-   bool was_on = safe_disable();
    int threshold = (TABLE_SIZE * duty) / 100;
-   for (int i = 0; i < TABLE_SIZE; i++) {
-      if (i < threshold)
-         write_awg_sample(i, DAC_MAX);
-      else
-         write_awg_sample(i, 0);
+   uint16_t pair[2];
+
+   set_write_bank(free_bank());
+   shadow_claim(bank_wr);
+   io_write(base_addr, RAM_ADDR_REG, 0);
+   for (int i = 0; i < TABLE_SIZE; i += 2) {
+      pair[0] = (i < threshold) ? DAC_MAX : 0;
+      pair[1] = (i + 1 < threshold) ? DAC_MAX : 0;
+      io_write(base_addr, RAM_PAIR_REG, (uint32_t) pair[0] | ((uint32_t) pair[1] << 16));
+      shadow_store(bank_wr, i, pair, 2);
    }
-   safe_restore(was_on);
+   select_bank(bank_wr);
 }
 
 void DdsAwgCore::gen_triangle_wave() {
-   bool was_on = safe_disable();
-   int half = TABLE_SIZE / 2;
-   for (int i = 0; i < TABLE_SIZE; i++) {
-      int val;
-      if (i < half)
-         val = (DAC_MAX * i) / half;
-      else
-         val = (DAC_MAX * (TABLE_SIZE - i)) / half;
-      write_awg_sample(i, val);
-   }
-   safe_restore(was_on);
+   load_awg_table(AWG_TRIANGLE.sample);
 }
 
 void DdsAwgCore::gen_sawtooth_wave() {
-   bool was_on = safe_disable();
-   for (int i = 0; i < TABLE_SIZE; i++) {
-      int val = (DAC_MAX * i) / TABLE_SIZE;
-      write_awg_sample(i, val);
+   load_awg_table(AWG_SAWTOOTH.sample);
+}
+
+// ---- Helper privado: banco AWG que no esta sonando ----
+// Solo pueden sonar el ultimo banco confirmado o el pedido (select_bank()
+// no pide otro con una conmutacion pendiente); se usa el siguiente al
+// pedido que no sea el confirmado, sin esperar al wrap.
+static_assert(DdsAwgCore::NUM_BANKS >= 3, "free_bank() necesita 3 bancos");
+
+int DdsAwgCore::free_bank() {
+   int bank = (bank_play + 1) & (NUM_BANKS - 1);
+   if (bank == bank_active && bank_swap_pending())
+      bank = (bank + 1) & (NUM_BANKS - 1);
+   return bank;
+}
+
+// ---- Helper privado: espera acotada a la conmutacion pendiente ----
+bool DdsAwgCore::wait_bank_swap() {
+   uint32_t t0 = now_tick32();
+
+   while (bank_swap_pending()) {
+      if (now_tick32() - t0 > BANK_SWAP_TIMEOUT_US * SYS_CLK_FREQ)
+         return false;
    }
-   safe_restore(was_on);
+   return true;
+}
+
+// ---- Helper privado: mantiene la copia sombra de la RAM AWG ----
+// La sombra sigue a un unico banco (shadow_bank); las cargas completas
+// la reasignan al banco que escriben (shadow_claim), ya que la van a
+// sobrescribir entera.
+void DdsAwgCore::shadow_claim(int bank) {
+   if (awg_shadow != 0)
+      shadow_bank = bank;
+}
+
+void DdsAwgCore::shadow_store(int bank, int addr, const uint16_t *data, int count) {
+   if (awg_shadow == 0 || bank != shadow_bank)
+      return;
+   for (int i = 0; i < count; i++)
+      awg_shadow[(addr + i) & (TABLE_SIZE - 1)] = data[i] & DAC_MAX;
+}
+
+// ---- Helper privado: commit inmediato fuera de una transaccion ----
+bool DdsAwgCore::apply() {
+   if (txn)
+      return true;
+   return commit();
 }
 
 // ---- Helpers privados para safe enable/disable ----
+// Solo deshabilitan la salida en modo RETUNE_DISABLE; en los demas modos
+// el cambio se aplica en caliente con un unico COMMIT.
 bool DdsAwgCore::safe_disable() {
    bool was_on = (ctrl_data & 0x01) != 0;
+   if (retune_mode != RETUNE_DISABLE)
+      return false;
    if (was_on) {
       enable(false);
    }
    return was_on;
 }
 
-void DdsAwgCore::safe_restore(bool was_on) {
+bool DdsAwgCore::safe_restore(bool was_on) {
    if (was_on) {
-      enable(true);
+      return enable(true);
    }
+   return true;
 }
@@ -1,27 +1,122 @@
 #ifndef _DDS_AWG_CORE_H_INCLUDED
 #define _DDS_AWG_CORE_H_INCLUDED
 #include "init.h"
+#include "dds_tuning.h"
 
 /**********************************************************************
  * DdsAwgCore driver  (slot 5)
  *  - compatible con dds_awg_slot.vhd
  *
  * Mapa de registros (offsets del slot):
- *  - reg 0 (R/W): FCW      - Frequency Control Word (32 bits)
+ *  - reg 0 (R/W): FCW      - Frequency Control Word (32 bits)  [sombra]
  *  - reg 1 (W):   CTRL     - Bit 0: Enable, Bit 1: Wave Select (0=Seno, 1=AWG)
+ *                            Bit 2: Phase Rst (el COMMIT reinicia el
+ *                            acumulador; se auto-borra)
+ *                            Bit 3: Sync Wait (el COMMIT espera al pulso
+ *                            SYNC del canal maestro; se auto-borra)
+ *                            [sombra]
  *  - reg 2 (W):   RAM_ADDR - Direccion de la RAM AWG a escribir (10 bits)
  *  - reg 3 (W):   RAM_DATA - Dato a escribir en la RAM AWG (14 bits),
- *                            la escritura dispara el pulso de WE
- *  - reg 4 (W):   POW      - Phase Offset Word (32 bits)
+ *                            la escritura dispara el pulso de WE y
+ *                            auto-incrementa RAM_ADDR
+ *  - reg 4 (W):   POW      - Phase Offset Word (32 bits)  [sombra]
+ *  - reg 5 (W):   RAM_PAIR - Dos muestras empaquetadas: bits 13..0 en
+ *                            RAM_ADDR, bits 29..16 en RAM_ADDR+1;
+ *                            auto-incrementa RAM_ADDR en 2
+ *  - reg 6 (W):   BANK_WR  - Banco AWG destino de las escrituras RAM
+ *  - reg 7 (W):   BANK_PLAY- Banco AWG a reproducir; conmuta en el
+ *                            siguiente wrap del acumulador de fase (se
+ *                            ignora con una conmutacion pendiente)
+ *  - reg 7 (R):   STATUS   - bit 0: conmutacion de banco pendiente,
+ *                            bit 1: ultimo COMMIT aplicado,
+ *                            bit 2: barrido en marcha,
+ *                            bit 3: CRC del banco en curso,
+ *                            bits 5..4: banco pedido
+ *  - reg 8 (W):   COMMIT   - pasa FCW/POW/CTRL y barrido sombra al
+ *                            dominio clk_dds de forma atomica
+ *                            (handshake); se ignora si el COMMIT
+ *                            anterior no se ha aplicado
+ *  - reg 9 (W):   SWEEP_START - FCW inicial del barrido  [sombra]
+ *  - reg 10 (W):  SWEEP_STEP  - incremento de FCW por escalon (lineal) o
+ *                               ratio Q0.16 (log: fcw += fcw*ratio/2^16)
+ *                               [sombra]
+ *  - reg 11 (W):  SWEEP_DWELL - ciclos de clk_dds por escalon (>= 2)
+ *                               [sombra]
+ *  - reg 12 (W):  SWEEP_STOP  - FCW final del barrido  [sombra]
+ *  - reg 13 (W):  SWEEP_CTRL  - Bit 0: Run, Bits 2..1: modo (0 parada,
+ *                               1 bucle, 2 ida y vuelta), Bit 3: Log,
+ *                               Bit 4: Go (el COMMIT arranca el barrido
+ *                               desde START; se auto-borra)  [sombra]
+ *  - reg 14 (W):  SYNC     - aplica en el mismo ciclo de clk_dds los
+ *                            COMMIT armados (Sync Wait) de todos los
+ *                            canales; solo tiene efecto en el maestro
+ *                            (slot 5)
+ *  - reg 15 (R):  CRC_WR   - CRC32 de las muestras escritas en la RAM
+ *                            AWG desde el ultimo reset
+ *  - reg 15 (W):  CRC_WR   - reinicia CRC_WR
+ *  - reg 16 (R):  CRC_SCAN - CRC32 del contenido del banco BANK_WR
+ *                            (valido con STATUS.scan_busy = 0)
+ *  - reg 16 (W):  CRC_SCAN - arranca el recorrido del banco BANK_WR
+ *                            (TABLE_SIZE/2 ciclos del bus)
  *
- * NOTA: rd_data devuelve SIEMPRE fcw_reg (cualquier lectura retorna FCW).
+ * CRC: CRC32 IEEE 802.3 (el de zlib) sobre cada muestra como 16 bits
+ * little-endian; coincide con awg_crc32() de la tabla escrita.
+ *
+ * NOTA: rd_data devuelve STATUS (reg 7), CRC_WR (reg 15) y CRC_SCAN
+ *       (reg 16); cualquier otra lectura devuelve fcw_reg.
  *       CTRL, RAM_ADDR y POW son write-only; se cachean en software.
  *
  * Parametros del hardware:
- *  - PHASE_WIDTH = 10 (1024 posiciones de tabla)
+ *  - PHASE_WIDTH = 10 (1024 posiciones de tabla AWG)
+ *  - SINE_PHASE_WIDTH = 12 (4096 posiciones de seno, ROM de 1/4 de onda
+ *    plegada por simetria: 1024 x 13 bits)
+ *  - BANK_BITS   = 2  (4 bancos AWG de TABLE_SIZE muestras)
  *  - DAC_WIDTH   = 14 (salida de 14 bits)
- *  - f_out = fcw * f_clk / 2^32
+ *  - LANES       = DDS_LANES (muestras por ciclo de clk_dds)
+ *  - f_out = fcw * f_s / 2^32, f_s = LANES * f_clk = DDS_SAMPLE_FREQ MHz
  *  - f_clk = DDS_CLK_FREQ MHz (165 MHz)
+ *  - Nyquist: f_s / 2 (todas las rutas de sintonia limitan a este valor)
+ *
+ * Transacciones:
+ *  - fuera de una transaccion cada setter hace su propio COMMIT
+ *  - la espera al COMMIT anterior esta acotada (COMMIT_TIMEOUT_US): con
+ *    clk_dds parado commit() y los setters devuelven false (y se deja
+ *    un registro en el trace) en lugar de bloquear el MCS
+ *  - begin() ... commit() agrupa varios cambios (FCW, POW, CTRL) en una
+ *    sola actualizacion sincronizada del DDS
+ *
+ * Modos de retune (set_retune_mode):
+ *  - RETUNE_CONTINUOUS (defecto): FCW/POW/onda cambian en caliente, el
+ *    acumulador de fase sigue corriendo (sin salto de fase ni mid-scale)
+ *  - RETUNE_RESTART: el COMMIT reinicia el acumulador a 0 sin pasar
+ *    por mid-scale
+ *  - RETUNE_DISABLE: comportamiento anterior, la salida se deshabilita
+ *    (mid-scale) durante la reconfiguracion
+ *
+ * Sintonia:
+ *  - set_freq()/set_phase() (double) usan soft-float en el MCS
+ *  - set_freq_mhz()/set_freq_uhz()/set_phase_mdeg() usan solo enteros
+ *    (ver dds_tuning.h), redondean al FCW/POW mas cercano y devuelven
+ *    el valor realmente programado
+ *
+ * Copia sombra de la RAM AWG (opcional, attach_awg_shadow):
+ *  - buffer de TABLE_SIZE muestras de 16 bits aportado por la aplicacion
+ *    que refleja el banco que esta sonando
+ *  - update_awg_table() compara la tabla nueva con la sombra y sube solo
+ *    los tramos modificados (auto-incremento + pares) sobre el banco
+ *    que suena; devuelve las escrituras de bus ahorradas
+ *
+ * Multicanal (ver dds_multi_core.h):
+ *  - commit_on_sync() arma el COMMIT: STATUS.update_done queda a 0
+ *    hasta que el maestro escribe SYNC (sync()); sync() en un canal
+ *    esclavo no tiene efecto, y sin el SYNC del maestro el siguiente
+ *    COMMIT del canal devuelve false al vencer COMMIT_TIMEOUT_US
+ *
+ * Barrido (sweep):
+ *  - con Run activo el FCW lo genera el motor de barrido del hardware
+ *    (un escalon cada SWEEP_DWELL ciclos, sin intervencion del MCS);
+ *    el registro FCW queda en espera hasta sweep_stop()
+ *  - los cambios de POW/CTRL durante un barrido no lo reinician
  **********************************************************************/
 class DdsAwgCore {
 public:
@@ -30,17 +125,90 @@ public:
     */
    enum {
       FCW_REG      = 0,   /**< R/W: Frequency Control Word (32 bits) */
-      CTRL_REG     = 1,   /**< W:   bit0=enable, bit1=wave_sel (cacheado en ctrl_data) */
+      CTRL_REG     = 1,   /**< W:   bit0=enable, bit1=wave_sel, bit2=phase_rst, bit3=sync_wait
+                                    (cacheado en ctrl_data; bits 2-3 se auto-borran en el COMMIT) */
       RAM_ADDR_REG = 2,   /**< W:   direccion RAM AWG (10 bits) */
       RAM_DATA_REG = 3,   /**< W:   dato RAM AWG (14 bits), dispara WE */
-      POW_REG      = 4    /**< W:   Phase Offset Word (32 bits) */
+      POW_REG      = 4,   /**< W:   Phase Offset Word (32 bits) */
+      RAM_PAIR_REG = 5,   /**< W:   dos muestras (13..0, 29..16), RAM_ADDR += 2 */
+      BANK_WR_REG  = 6,   /**< W:   banco destino de las escrituras RAM */
+      BANK_PLAY_REG= 7,   /**< W:   banco a reproducir (conmuta en el wrap) */
+      STATUS_REG   = 7,   /**< R:   estado (ver mascaras) */
+      COMMIT_REG   = 8,   /**< W:   aplica FCW/POW/CTRL y barrido sombra */
+      SWEEP_START_REG = 9,  /**< W: FCW inicial del barrido */
+      SWEEP_STEP_REG  = 10, /**< W: incremento (lineal) o ratio Q0.16 (log) */
+      SWEEP_DWELL_REG = 11, /**< W: ciclos de clk_dds por escalon */
+      SWEEP_STOP_REG  = 12, /**< W: FCW final del barrido */
+      SWEEP_CTRL_REG  = 13, /**< W: control del barrido (cacheado en sweep_ctrl) */
+      SYNC_REG        = 14, /**< W: pulso de sincronismo multicanal (maestro) */
+      CRC_WR_REG      = 15, /**< R: CRC32 de las escrituras, W: reinicio */
+      CRC_SCAN_REG    = 16  /**< R: CRC32 del banco BANK_WR, W: arranque */
+   };
+
+   /**
+    * mascaras del registro STATUS
+    */
+   enum {
+      BANK_PENDING_FIELD = 0x00000001,  /**< bit 0: conmutacion de banco pendiente */
+      UPDATE_DONE_FIELD  = 0x00000002,  /**< bit 1: ultimo COMMIT aplicado */
+      SWEEP_ACTIVE_FIELD = 0x00000004,  /**< bit 2: barrido en marcha */
+      SCAN_BUSY_FIELD    = 0x00000008,  /**< bit 3: CRC del banco en curso */
+      PHASE_RST_FIELD    = 0x00000004,  /**< CTRL bit 2: reinicio de fase en el COMMIT */
+      SYNC_WAIT_FIELD    = 0x00000008,  /**< CTRL bit 3: el COMMIT espera a SYNC */
+      BANK_PLAY_FIELD    = 0x00000030   /**< bits 5..4: banco pedido */
    };
 
    // Constantes del hardware
    static const int PHASE_WIDTH = 10;
    static const int TABLE_SIZE  = 1 << PHASE_WIDTH;  // 1024
+   static const int SINE_PHASE_WIDTH = 12;
+   static const int SINE_TABLE_SIZE  = 1 << SINE_PHASE_WIDTH;  // 4096
    static const int DAC_WIDTH   = 14;
    static const int DAC_MAX     = (1 << DAC_WIDTH) - 1;  // 16383
+   static const int BANK_BITS   = 2;
+   static const int LANES       = DDS_LANES;
+   static const int NUM_BANKS   = 1 << BANK_BITS;        // 4
+   // espera maxima de select_bank() a la conmutacion anterior; con la
+   // salida habilitada y FCW = 0 el acumulador no desborda nunca
+   static const uint32_t BANK_SWAP_TIMEOUT_US = 100000;
+   // espera maxima de commit() al COMMIT anterior (el handshake tarda
+   // unos ciclos; solo vence con clk_dds parado o el slot en reset)
+   static const uint32_t COMMIT_TIMEOUT_US = 1000;
+
+   /**
+    * mascaras del registro SWEEP_CTRL
+    */
+   enum {
+      SWEEP_RUN_FIELD  = 0x00000001,  /**< bit 0: el barrido gobierna el FCW */
+      SWEEP_MODE_FIELD = 0x00000006,  /**< bits 2..1: parada / bucle / ida y vuelta */
+      SWEEP_LOG_FIELD  = 0x00000008,  /**< bit 3: escalones logaritmicos */
+      SWEEP_GO_FIELD   = 0x00000010   /**< bit 4: arranca desde START (auto-borrado) */
+   };
+
+   /**
+    * modos de barrido (SWEEP_LOG se combina con OR)
+    */
+   enum {
+      SWEEP_SINGLE = 0,  /**< start -> stop y se queda en stop */
+      SWEEP_LOOP   = 1,  /**< start -> stop y vuelve a empezar */
+      SWEEP_UPDOWN = 2,  /**< start -> stop -> start ... */
+      SWEEP_LOG    = 8   /**< escalones proporcionales al FCW (log) */
+   };
+   static const uint32_t SWEEP_MIN_DWELL = 2;  // latencia del producto log
+   // escrituras de bus de load_awg_table(): BANK_WR + CRC_WR + RAM_ADDR + pares + BANK_PLAY
+   static const int AWG_FULL_WRITES = TABLE_SIZE / 2 + 4;
+   // huecos sin cambios de hasta AWG_GAP_MERGE muestras se reescriben
+   // (cuesta lo mismo o menos que una nueva escritura de RAM_ADDR)
+   static const int AWG_GAP_MERGE = 2;
+
+   /**
+    * modos de retune
+    */
+   enum {
+      RETUNE_CONTINUOUS = 0,  /**< cambio en caliente, fase continua */
+      RETUNE_RESTART    = 1,  /**< reinicia la fase en cada COMMIT */
+      RETUNE_DISABLE    = 2   /**< deshabilita la salida durante el cambio */
+   };
 
    /**
     * constructor.
@@ -51,28 +219,55 @@ public:
 
    /**
     * configura la frecuencia de salida.
-    * f_out = fcw * f_clk / 2^32
+    * f_out = fcw * f_s / 2^32
     * @param freq_hz frecuencia deseada en Hz
+    * @return false si el COMMIT no se aplica en COMMIT_TIMEOUT_US
+    * @note aritmetica double (soft-float en el MCS); truncado
     */
-   void set_freq(double freq_hz);
+   bool set_freq(double freq_hz);
+
+   /**
+    * configura la frecuencia de salida en mili-hercios (solo enteros).
+    * @param freq_mhz frecuencia deseada en mHz (se limita a Nyquist)
+    * @return frecuencia real obtenida en mHz
+    */
+   uint64_t set_freq_mhz(uint64_t freq_mhz);
+
+   /**
+    * configura la frecuencia de salida en micro-hercios (solo enteros).
+    * @param freq_uhz frecuencia deseada en uHz (se limita a Nyquist)
+    * @return frecuencia real obtenida en uHz
+    */
+   uint64_t set_freq_uhz(uint64_t freq_uhz);
 
    /**
     * escribe directamente el FCW (Frequency Control Word).
     * @param fcw valor del FCW (32 bits)
+    * @return false si el COMMIT no se aplica en COMMIT_TIMEOUT_US
     */
-   void set_fcw(uint32_t fcw);
+   bool set_fcw(uint32_t fcw);
 
    /**
     * configura el desfase inicial.
     * @param degrees desfase en grados (0.0 - 360.0)
+    * @return false si el COMMIT no se aplica en COMMIT_TIMEOUT_US
+    * @note aritmetica double (soft-float en el MCS); truncado
     */
-   void set_phase(double degrees);
+   bool set_phase(double degrees);
+
+   /**
+    * configura el desfase inicial en mili-grados (solo enteros).
+    * @param mdeg desfase en mili-grados (se reduce modulo 360000)
+    * @return desfase real obtenido en mili-grados
+    */
+   uint32_t set_phase_mdeg(uint32_t mdeg);
 
    /**
     * escribe directamente el POW (Phase Offset Word).
     * @param pow valor del POW (32 bits)
+    * @return false si el COMMIT no se aplica en COMMIT_TIMEOUT_US
     */
-   void set_pow(uint32_t pow);
+   bool set_pow(uint32_t pow);
 
    /**
     * lee el FCW actual.
@@ -86,12 +281,24 @@ public:
     */
    double get_freq();
 
+   /**
+    * lee la frecuencia actual en uHz (solo enteros).
+    * @return frecuencia en uHz
+    */
+   uint64_t get_freq_uhz();
+
    /**
     * lee el desfase actual (cacheado en software).
     * @return desfase en grados
     */
    double get_phase();
 
+   /**
+    * lee el desfase actual en mili-grados (solo enteros).
+    * @return desfase en mili-grados
+    */
+   uint32_t get_phase_mdeg();
+
    /**
     * lee el POW actual (cacheado en software).
     * @return valor del POW
@@ -101,14 +308,128 @@ public:
    /**
     * habilita/deshabilita la salida del generador.
     * @param on true para habilitar, false para deshabilitar (salida a mid-scale)
+    * @return false si el COMMIT no se aplica en COMMIT_TIMEOUT_US
     */
-   void enable(bool on);
+   bool enable(bool on);
 
    /**
     * selecciona la forma de onda.
     * @param sel 0 = Senoidal (ROM), 1 = Arbitraria (RAM AWG)
+    * @return false si el COMMIT no se aplica en COMMIT_TIMEOUT_US
+    */
+   bool select_wave(int sel);
+
+   /**
+    * selecciona como se aplican los cambios de FCW/POW/onda.
+    * @param mode RETUNE_CONTINUOUS, RETUNE_RESTART o RETUNE_DISABLE
+    */
+   void set_retune_mode(int mode);
+
+   /**
+    * lee el modo de retune actual.
+    * @return RETUNE_CONTINUOUS, RETUNE_RESTART o RETUNE_DISABLE
+    */
+   int get_retune_mode();
+
+   /**
+    * reinicia el acumulador de fase en el siguiente COMMIT (inmediato
+    * fuera de una transaccion), sin deshabilitar la salida.
+    * @return false si el COMMIT no se aplica en COMMIT_TIMEOUT_US
+    */
+   bool reset_phase();
+
+   /**
+    * abre una transaccion: los setters siguientes (FCW, POW, CTRL) solo
+    * escriben los registros sombra hasta commit().
+    * @note dentro de una transaccion no hay deshabilitacion intermedia
+    *       de la salida (enable(false)/enable(true) se anulan)
+    */
+   void begin();
+
+   /**
+    * aplica todos los cambios pendientes en una sola actualizacion
+    * sincronizada y cierra la transaccion.
+    * @return false si el COMMIT anterior no se aplica en
+    *         COMMIT_TIMEOUT_US (clk_dds parado): no se envia y los
+    *         cambios quedan en los registros sombra
+    * @note espera a que el COMMIT anterior se haya aplicado
+    */
+   bool commit();
+
+   /**
+    * como commit(), pero el hardware retiene los cambios hasta el
+    * siguiente pulso SYNC del canal maestro.
+    * @param phase_rst true para reiniciar tambien el acumulador de fase
+    * @return false si el COMMIT anterior no se aplica en
+    *         COMMIT_TIMEOUT_US (p.ej. otro COMMIT armado sin SYNC)
+    * @note hasta el SYNC, update_applied() devuelve false y cualquier
+    *       COMMIT posterior del canal (setters incluidos) vence su
+    *       espera: el SYNC lo da el maestro, no este canal
+    */
+   bool commit_on_sync(bool phase_rst);
+
+   /**
+    * genera el pulso SYNC: todos los canales con un COMMIT armado lo
+    * aplican en el mismo ciclo de clk_dds (solo en el canal maestro).
+    */
+   void sync();
+
+   /**
+    * comprueba si el ultimo COMMIT ya se ha aplicado en el dominio DDS.
+    * @return true si se ha aplicado
+    */
+   bool update_applied();
+
+   /**
+    * espera (acotada) a que el ultimo COMMIT se aplique.
+    * @return false si no se aplica en COMMIT_TIMEOUT_US
     */
-   void select_wave(int sel);
+   bool wait_applied();
+
+   /**
+    * programa un barrido de frecuencia que corre en el hardware.
+    * calcula escalon y dwell (solo enteros) para cubrir start..stop en
+    * duration_us: con el mayor numero de escalones posible (dwell
+    * minimo SWEEP_MIN_DWELL) y como mucho un LSB de FCW por escalon.
+    * @param start_hz frecuencia inicial en Hz (se limita a Nyquist; en
+    *        log, 0 Hz se sube a 1 LSB de FCW)
+    * @param stop_hz frecuencia final en Hz (se limita a Nyquist; en
+    *        log, 0 Hz se sube a 1 LSB de FCW)
+    * @param duration_us duracion de un tramo start -> stop en us
+    * @param mode SWEEP_SINGLE, SWEEP_LOOP o SWEEP_UPDOWN, opcionalmente
+    *        con SWEEP_LOG
+    * @note en modo log la duracion es aproximada (ln(1+x) ~ x) y, con
+    *       FCW bajo (FCW * step < 2^16), el hardware avanza 1 LSB por
+    *       escalon, asi que ese tramo dura mas de lo pedido; el barrido
+    *       siempre termina exactamente en stop
+    * @return false si el COMMIT no se aplica en COMMIT_TIMEOUT_US
+    */
+   bool sweep(uint32_t start_hz, uint32_t stop_hz, uint32_t duration_us, int mode);
+
+   /**
+    * programa un barrido con los valores crudos de los registros.
+    * @param start_fcw FCW inicial
+    * @param stop_fcw FCW final
+    * @param step incremento de FCW (lineal) o ratio Q0.16 (SWEEP_LOG)
+    * @param dwell ciclos de clk_dds por escalon (>= SWEEP_MIN_DWELL)
+    * @param mode SWEEP_SINGLE, SWEEP_LOOP o SWEEP_UPDOWN (| SWEEP_LOG)
+    * @return false si el COMMIT no se aplica en COMMIT_TIMEOUT_US
+    */
+   bool sweep_fcw(uint32_t start_fcw, uint32_t stop_fcw, uint32_t step,
+                  uint32_t dwell, int mode);
+
+   /**
+    * detiene el barrido; el DDS vuelve al FCW del registro FCW.
+    * @return false si el COMMIT no se aplica en COMMIT_TIMEOUT_US
+    */
+   bool sweep_stop();
+
+   /**
+    * comprueba si el barrido sigue en marcha.
+    * @return true si no ha terminado (los modos bucle e ida y vuelta
+    *         no terminan nunca)
+    */
+   bool sweep_running();
 
    /**
     * escribe una muestra en la tabla RAM de forma de onda arbitraria.
@@ -117,11 +438,165 @@ public:
     */
    void write_awg_sample(int addr, int data);
 
+   /**
+    * escribe un bloque de muestras consecutivas en la RAM AWG usando el
+    * auto-incremento y el registro empaquetado: 1 + ceil(count/2)
+    * escrituras en el bus en lugar de 2*count.
+    * @param data puntero a count muestras (cada una 0..DAC_MAX)
+    * @param start direccion de la primera muestra (0..TABLE_SIZE-1)
+    * @param count numero de muestras (la direccion da la vuelta en TABLE_SIZE)
+    * @note no deshabilita la salida
+    */
+   void load_awg_burst(const uint16_t *data, int start, int count);
+
    /**
     * carga una tabla completa de forma de onda arbitraria.
+    * se escribe en un banco libre y se conmuta a el en el siguiente wrap;
+    * la salida no se deshabilita. La carga se comprueba con una lectura
+    * de CRC_WR; si no coincide no se conmuta de banco.
+    * @param table puntero a un array de TABLE_SIZE muestras (cada una 0..DAC_MAX)
+    * @return true si el CRC del hardware coincide con el de la tabla
+    */
+   bool load_awg_table(const int *table);
+
+   /**
+    * carga una tabla completa de forma de onda arbitraria (16 bits).
+    * ruta unica de carga para las tablas precalculadas (awg_waveforms.h):
+    * solo escrituras en el bus, sin calculo por muestra.
+    * se escribe en un banco libre y se conmuta a el (sin deshabilitar)
+    * si el CRC de las escrituras coincide.
+    * @param table puntero a un array de TABLE_SIZE muestras (cada una 0..DAC_MAX)
+    * @return true si el CRC del hardware coincide con el de la tabla
+    */
+   bool load_awg_table(const uint16_t *table);
+
+   /**
+    * selecciona el banco AWG destino de las escrituras en RAM.
+    * @param bank banco (0..NUM_BANKS-1)
+    */
+   void set_write_bank(int bank);
+
+   /**
+    * lee el banco AWG destino de las escrituras (cacheado en software).
+    * @return banco (0..NUM_BANKS-1)
+    */
+   int get_write_bank();
+
+   /**
+    * pide reproducir un banco AWG. El cambio se aplica en el siguiente
+    * wrap del acumulador de fase (de inmediato si la salida esta
+    * deshabilitada); la salida no se deshabilita.
+    * @param bank banco (0..NUM_BANKS-1)
+    * @return false si la conmutacion anterior no se aplica en
+    *         BANK_SWAP_TIMEOUT_US (la peticion no se envia)
+    * @note espera a que se aplique la conmutacion anterior: el hardware
+    *       ignora BANK_PLAY mientras hay una pendiente
+    */
+   bool select_bank(int bank);
+
+   /**
+    * lee el ultimo banco AWG pedido para reproducir.
+    * @return banco (0..NUM_BANKS-1)
+    */
+   int get_play_bank();
+
+   /**
+    * comprueba si hay una conmutacion de banco pendiente del wrap.
+    * @return true si la peticion aun no se ha aplicado
+    */
+   bool bank_swap_pending();
+
+   /**
+    * carga una tabla completa en un banco concreto (rafaga) y la
+    * comprueba con el CRC de las escrituras (una lectura).
+    * @param bank banco destino (0..NUM_BANKS-1)
+    * @param table puntero a un array de TABLE_SIZE muestras
+    * @return true si el CRC del hardware coincide con el de la tabla
+    * @note no deshabilita la salida ni conmuta de banco
+    */
+   bool load_awg_bank(int bank, const uint16_t *table);
+
+   /**
+    * calcula en hardware el CRC32 del contenido de un banco AWG
+    * (recorre la RAM; selecciona bank como banco de escritura).
+    * @param bank banco (0..NUM_BANKS-1)
+    * @return CRC32 de las TABLE_SIZE muestras del banco
+    */
+   uint32_t get_awg_bank_crc(int bank);
+
+   /**
+    * comprueba el contenido de un banco AWG contra una tabla.
+    * @param bank banco (0..NUM_BANKS-1)
+    * @param table puntero a un array de TABLE_SIZE muestras
+    * @return true si el banco contiene exactamente la tabla
+    */
+   bool verify_awg_bank(int bank, const uint16_t *table);
+
+   /**
+    * CRC32 (IEEE 802.3) de muestras AWG tal y como lo calcula el
+    * hardware (cada muestra enmascarada a DAC_MAX, 16 bits LE).
+    * @param data puntero a count muestras
+    * @param count numero de muestras
+    * @return CRC32
+    */
+   static uint32_t awg_crc32(const uint16_t *data, int count);
+
+   /**
+    * abre la carga por flujo de una tabla completa: el banco libre pasa
+    * a ser el de escritura y las muestras llegan de dos en dos con
+    * awg_stream_pair() segun se reciben (sin buffer de tabla).
+    */
+   void awg_stream_begin();
+
+   /**
+    * escribe el siguiente par de muestras de la carga por flujo.
+    * @param s0 muestra en la posicion actual (0..DAC_MAX)
+    * @param s1 muestra en la posicion siguiente (0..DAC_MAX)
+    * @note los pares que exceden TABLE_SIZE muestras se descartan
+    */
+   void awg_stream_pair(uint16_t s0, uint16_t s1);
+
+   /**
+    * cierra la carga por flujo y la comprueba con CRC_WR (una lectura).
+    * @param play true para conmutar al banco cargado si es correcto
+    * @return true si llegaron TABLE_SIZE muestras y el CRC del
+    *         hardware coincide con el de las muestras enviadas
+    * @note si falla no se conmuta de banco
+    */
+   bool awg_stream_end(bool play);
+
+   /**
+    * CRC32 de las muestras enviadas en la carga por flujo en curso (o
+    * la ultima); con la tabla completa coincide con awg_crc32() de la
+    * tabla, p.ej. para compararlo con un CRC guardado junto a ella.
+    * @return CRC32 de las muestras enviadas desde awg_stream_begin()
+    */
+   uint32_t awg_stream_crc();
+
+   /**
+    * asocia (o quita, con 0) la copia sombra de la RAM AWG.
+    * la sombra no es valida hasta la siguiente carga completa.
+    * @param buf buffer de TABLE_SIZE muestras, propiedad de la aplicacion
+    */
+   void attach_awg_shadow(uint16_t *buf);
+
+   /**
+    * actualiza la tabla que esta sonando subiendo solo las muestras que
+    * difieren de la copia sombra. Los tramos contiguos (y los separados
+    * por huecos de hasta AWG_GAP_MERGE muestras) se suben en rafaga.
+    * Sin sombra valida, o si la sombra no es del banco que suena, hace
+    * una carga completa con load_awg_table().
     * @param table puntero a un array de TABLE_SIZE muestras (cada una 0..DAC_MAX)
+    * @return escrituras de bus ahorradas frente a load_awg_table()
+    * @note los cambios son audibles muestra a muestra (edicion en vivo)
+    */
+   int update_awg_table(const uint16_t *table);
+
+   /**
+    * total de escrituras de bus ahorradas por update_awg_table().
+    * @return escrituras ahorradas desde el arranque
     */
-   void load_awg_table(const int *table);
+   uint32_t get_awg_writes_saved();
 
    /**
     * genera una tabla de onda cuadrada y la carga en la RAM AWG.
@@ -130,21 +605,38 @@ public:
    void gen_square_wave(int duty);
 
    /**
-    * genera una tabla de onda triangular y la carga en la RAM AWG.
+    * carga la tabla triangular precalculada (AWG_TRIANGLE) en la RAM AWG.
     */
    void gen_triangle_wave();
 
    /**
-    * genera una tabla de onda diente de sierra y la carga en la RAM AWG.
+    * carga la tabla diente de sierra precalculada (AWG_SAWTOOTH) en la RAM AWG.
     */
    void gen_sawtooth_wave();
 
 private:
    uint32_t base_addr;
    uint32_t ctrl_data;   // registro de control en cache
+   uint32_t ctrl_once;   // bits de CTRL de un solo COMMIT (Phase Rst)
    uint32_t pow_data;    // POW en cache
+   int bank_wr;          // banco destino de escrituras en cache
+   int bank_play;        // ultimo banco pedido para reproducir
+   int bank_active;      // ultimo banco confirmado por el hardware
+   bool txn;             // transaccion abierta (begin() sin commit())
+   int retune_mode;      // RETUNE_CONTINUOUS / RETUNE_RESTART / RETUNE_DISABLE
+   uint32_t sweep_ctrl;  // registro SWEEP_CTRL en cache (sin Go)
+   uint16_t *awg_shadow; // copia sombra de la RAM AWG (0: sin sombra)
+   int shadow_bank;      // banco que refleja la sombra (-1: no valida)
+   uint32_t writes_saved;// escrituras ahorradas por update_awg_table()
+   int stream_pos;       // muestras recibidas en la carga por flujo
+   uint32_t stream_crc;  // CRC32 (sin invertir) de la carga por flujo
+   bool apply();
+   int free_bank();
+   bool wait_bank_swap();
+   void shadow_claim(int bank);
+   void shadow_store(int bank, int addr, const uint16_t *data, int count);
    bool safe_disable();
-   void safe_restore(bool was_on);
+   bool safe_restore(bool was_on);
 };
 
 #endif  // _DDS_AWG_CORE_H_INCLUDED
@@ -0,0 +1,239 @@
+#include "dds_link.h"
+#include "trace.h"
+
+DdsLink::DdsLink(UartCore *uart_p, DdsAwgCore *const *chan, int n) {
+   uart = uart_p;
+   ch = chan;
+   num_ch = n;
+   state = S_SOF;
+   len = 0;
+   pos = 0;
+   op = 0;
+   chan_idx = 0;
+   status = ST_OK;
+   crc = 0xFFFF;
+   crc_rx = 0;
+   t_last = 0;
+   frames_ok = 0;
+   frames_bad = 0;
+}
+
+DdsLink::~DdsLink() {
+}
+
+int DdsLink::poll() {
+   uint8_t rx[16];
+   int n, i, total = 0;
+
+   do {
+      n = uart->rx_read(rx, sizeof(rx));
+      for (i = 0; i < n; i++)
+         feed(rx[i]);
+      total += n;
+   } while (n == (int) sizeof(rx));
+   return (total);
+}
+
+void DdsLink::feed(uint8_t byte) {
+   unsigned long now = now_ms();
+
+   // trama cortada: se descarta (la carga por flujo no conmuta de banco)
+   if (state != S_SOF && now - t_last > LINK_TIMEOUT_MS) {
+      if (state >= S_PAYLOAD && op == OP_AWG_LOAD && status == ST_OK)
+         ch[chan_idx]->awg_stream_end(false);
+      frames_bad++;
+      state = S_SOF;
+   }
+   t_last = now;
+
+   switch (state) {
+   case S_SOF:
+      if (byte == SOF) {
+         crc = 0xFFFF;
+         state = S_LEN0;
+      }
+      break;
+   case S_LEN0:
+      crc = crc16_upd(crc, byte);
+      len = byte;
+      state = S_LEN1;
+      break;
+   case S_LEN1:
+      crc = crc16_upd(crc, byte);
+      len |= (int) byte << 8;
+      state = S_OP;
+      break;
+   case S_OP:
+      crc = crc16_upd(crc, byte);
+      op = byte;
+      state = S_CH;
+      break;
+   case S_CH:
+      crc = crc16_upd(crc, byte);
+      chan_idx = byte;
+      header_done();
+      state = (len > 0) ? S_PAYLOAD : S_CRC0;
+      break;
+   case S_PAYLOAD:
+      crc = crc16_upd(crc, byte);
+      payload_byte(byte);
+      pos++;
+      if (pos == len)
+         state = S_CRC0;
+      break;
+   case S_CRC0:
+      crc_rx = byte;
+      state = S_CRC1;
+      break;
+   default:  // S_CRC1
+      crc_rx |= (uint16_t) byte << 8;
+      frame_done();
+      state = S_SOF;
+      break;
+   }
+}
+
+uint32_t DdsLink::get_frames_ok() {
+   return (frames_ok);
+}
+
+uint32_t DdsLink::get_frames_bad() {
+   return (frames_bad);
+}
+
+// ---- Helper privado: cabecera completa, valida LEN/canal ----
+// OP_AWG_LOAD abre aqui la carga por flujo; el resto de comandos
+// guardan el PAYLOAD en buf y se ejecutan al final de la trama.
+void DdsLink::header_done() {
+   pos = 0;
+   status = ST_OK;
+   if (chan_idx >= num_ch)
+      status = ST_BAD_CH;
+   else if (op == OP_AWG_LOAD) {
+      if (len != 2 * DdsAwgCore::TABLE_SIZE)
+         status = ST_BAD_LEN;
+      else
+         ch[chan_idx]->awg_stream_begin();
+   } else if (len > MAX_PAYLOAD)
+      status = ST_BAD_LEN;
+}
+
+void DdsLink::payload_byte(uint8_t byte) {
+   if (status != ST_OK)
+      return;  // se consume la trama sin guardarla
+   if (op == OP_AWG_LOAD) {
+      pair[pos & 3] = byte;
+      if ((pos & 3) == 3)
+         ch[chan_idx]->awg_stream_pair((uint16_t) pair[0] | ((uint16_t) pair[1] << 8),
+                                       (uint16_t) pair[2] | ((uint16_t) pair[3] << 8));
+   } else
+      buf[pos] = byte;
+}
+
+void DdsLink::frame_done() {
+   uint8_t st;
+
+   if (crc != crc_rx) {
+      if (op == OP_AWG_LOAD && status == ST_OK)
+         ch[chan_idx]->awg_stream_end(false);
+      frames_bad++;
+      trace(TRACE_LINK, "link bad crc", op, crc_rx);
+      reply(ST_BAD_CRC);
+      return;
+   }
+   frames_ok++;
+   st = (status != ST_OK) ? status : execute(ch[chan_idx]);
+   trace(TRACE_LINK, "link frame", op, st);
+   reply(st);
+}
+
+uint8_t DdsLink::execute(DdsAwgCore *dds_p) {
+   uint64_t uhz;
+   int i;
+
+   switch (op) {
+   case OP_PING:
+      return (ST_OK);
+   case OP_SET_FCW:
+   case OP_SET_POW:
+      if (len != 4)
+         return (ST_BAD_LEN);
+      return (apply_reg(dds_p, op, get_u32(buf)) ? ST_OK : ST_TIMEOUT);
+   case OP_ENABLE:
+   case OP_WAVE:
+      if (len != 1)
+         return (ST_BAD_LEN);
+      return (apply_reg(dds_p, op, buf[0]) ? ST_OK : ST_TIMEOUT);
+   case OP_FREQ_UHZ:
+      if (len != 8)
+         return (ST_BAD_LEN);
+      uhz = (uint64_t) get_u32(buf) | ((uint64_t) get_u32(buf + 4) << 32);
+      // un COMMIT explicito para saber si se ha aplicado
+      dds_p->begin();
+      dds_p->set_freq_uhz(uhz);
+      return (dds_p->commit() ? ST_OK : ST_TIMEOUT);
+   case OP_BATCH:
+      if (len == 0 || len % 5 != 0)
+         return (ST_BAD_LEN);
+      // validar antes de tocar el hardware: o se aplica todo o nada
+      for (i = 0; i < len; i += 5) {
+         if (buf[i] < OP_SET_FCW || buf[i] > OP_WAVE)
+            return (ST_BAD_OP);
+      }
+      dds_p->begin();
+      for (i = 0; i < len; i += 5)
+         apply_reg(dds_p, buf[i], get_u32(buf + i + 1));
+      return (dds_p->commit() ? ST_OK : ST_TIMEOUT);
+   case OP_AWG_LOAD:
+      return (dds_p->awg_stream_end(true) ? ST_OK : ST_AWG_FAIL);
+   default:
+      return (ST_BAD_OP);
+   }
+}
+
+bool DdsLink::apply_reg(DdsAwgCore *dds_p, uint8_t sub, uint32_t val) {
+   switch (sub) {
+   case OP_SET_FCW:
+      return (dds_p->set_fcw(val));
+   case OP_SET_POW:
+      return (dds_p->set_pow(val));
+   case OP_ENABLE:
+      return (dds_p->enable(val != 0));
+   case OP_WAVE:
+      return (dds_p->select_wave((int) val));
+   default:
+      return (false);
+   }
+}
+
+void DdsLink::reply(uint8_t st) {
+   uint8_t frame[8];
+   uint16_t c = 0xFFFF;
+   int i;
+
+   frame[0] = SOF;
+   frame[1] = 1;
+   frame[2] = 0;
+   frame[3] = op | OP_REPLY;
+   frame[4] = chan_idx;
+   frame[5] = st;
+   for (i = 1; i < 6; i++)
+      c = crc16_upd(c, frame[i]);
+   frame[6] = (uint8_t) c;
+   frame[7] = (uint8_t) (c >> 8);
+   for (i = 0; i < 8; i++)
+      uart->tx_byte(frame[i]);
+}
+
+// CRC-16/CCITT-FALSE bit a bit (sin tabla: el enlace va a 9600 baud)
+uint16_t DdsLink::crc16_upd(uint16_t c, uint8_t byte) {
+   c ^= (uint16_t) byte << 8;
+   for (int b = 0; b < 8; b++)
+      c = (c & 0x8000) ? (uint16_t) ((c << 1) ^ 0x1021) : (uint16_t) (c << 1);
+   return (c);
+}
+
+uint32_t DdsLink::get_u32(const uint8_t *p) {
+   return ((uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16)
+           | ((uint32_t) p[3] << 24));
+}
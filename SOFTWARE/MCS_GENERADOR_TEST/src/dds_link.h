@@ -0,0 +1,144 @@
+#ifndef _DDS_LINK_H_INCLUDED
+#define _DDS_LINK_H_INCLUDED
+#include "uart_core.h"
+#include "dds_awg_core.h"
+
+/**********************************************************************
+ * DdsLink: protocolo binario por UART para controlar el generador
+ *  - se alimenta de UartCore::rx_read() desde poll() (sin esperas)
+ *  - cada trama se traduce a llamadas de DdsAwgCore sobre el canal
+ *    indicado
+ *
+ * Trama (host -> MCS), campos multibyte en little-endian:
+ *    SOF(0xA5) | LEN(2) | OP(1) | CH(1) | PAYLOAD(LEN) | CRC(2)
+ *  - LEN: bytes de PAYLOAD
+ *  - CRC: CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) de LEN..PAYLOAD
+ *  - entre dos bytes de una trama no pueden pasar mas de
+ *    LINK_TIMEOUT_MS; si pasan se descarta y se busca un nuevo SOF
+ *
+ * Respuesta (MCS -> host), una por trama:
+ *    SOF(0xA5) | LEN=1 (2) | OP|0x80 | CH | STATUS | CRC(2)
+ *
+ * Opcodes:
+ *  - OP_PING      (LEN 0)  solo responde
+ *  - OP_SET_FCW   (LEN 4)  set_fcw(u32)
+ *  - OP_SET_POW   (LEN 4)  set_pow(u32)
+ *  - OP_ENABLE    (LEN 1)  enable(u8 != 0)
+ *  - OP_WAVE      (LEN 1)  select_wave(u8)
+ *  - OP_FREQ_UHZ  (LEN 8)  set_freq_uhz(u64)
+ *  - OP_BATCH     (LEN 5*n, n <= BATCH_MAX) registros {sub-op(1),
+ *                 valor u32(4)} con sub-op OP_SET_FCW/POW/ENABLE/WAVE;
+ *                 se aplican todos en una sola transaccion
+ *                 (begin() ... commit(): un unico COMMIT)
+ *  - OP_AWG_LOAD  (LEN 2*TABLE_SIZE) tabla completa, muestras u16; cada
+ *                 par se escribe en RAM_PAIR segun llega (carga por
+ *                 flujo, sin buffer de tabla). Con el CRC de la trama
+ *                 y el CRC_WR del hardware correctos se conmuta al
+ *                 banco nuevo; si no, sigue sonando el anterior
+ *
+ * Los comandos con PAYLOAD en buffer (todos salvo OP_AWG_LOAD) solo se
+ * ejecutan si el CRC de la trama es correcto.
+ Los ajustes de registros responden ST_TIMEOUT si su COMMIT no llega
+ * a aplicarse (DdsAwgCore::commit() devuelve false).
+ *
+ * Cliente de referencia del host: test/link_client.h (tramas y CRC);
+ * test/test_dds_link.cpp lo prueba en bucle contra la uart simulada.
+ **********************************************************************/
+class DdsLink {
+public:
+   /**
+    * opcodes
+    */
+   enum {
+      OP_PING = 0x01,      /**< eco */
+      OP_SET_FCW = 0x10,   /**< FCW (u32) */
+      OP_SET_POW = 0x11,   /**< POW (u32) */
+      OP_ENABLE = 0x12,    /**< habilita la salida (u8) */
+      OP_WAVE = 0x13,      /**< 0 = seno, 1 = AWG (u8) */
+      OP_FREQ_UHZ = 0x14,  /**< frecuencia en uHz (u64) */
+      OP_BATCH = 0x20,     /**< varios ajustes en un solo COMMIT */
+      OP_AWG_LOAD = 0x30,  /**< tabla AWG por flujo */
+      OP_REPLY = 0x80      /**< bit de respuesta */
+   };
+   /**
+    * codigos de STATUS de la respuesta
+    */
+   enum {
+      ST_OK = 0,           /**< comando ejecutado */
+      ST_BAD_CRC = 1,      /**< CRC de trama incorrecto */
+      ST_BAD_OP = 2,       /**< opcode (o sub-op de OP_BATCH) desconocido */
+      ST_BAD_LEN = 3,      /**< LEN no valido para el opcode */
+      ST_BAD_CH = 4,       /**< canal inexistente */
+      ST_AWG_FAIL = 5,     /**< CRC_WR del hardware no coincide */
+      ST_TIMEOUT = 6       /**< el COMMIT no se aplica (clk_dds parado) */
+   };
+   static const uint8_t SOF = 0xA5;
+   static const int MAX_PAYLOAD = 64;          // comandos con buffer
+   static const int BATCH_MAX = MAX_PAYLOAD / 5;
+   static const unsigned long LINK_TIMEOUT_MS = 100;
+
+   /**
+    * constructor.
+    * @param uart_p uart del enlace
+    * @param chan array de n canales DDS (CH indexa este array)
+    * @param n numero de canales
+    */
+   DdsLink(UartCore *uart_p, DdsAwgCore *const *chan, int n);
+   ~DdsLink();
+
+   /**
+    * procesa los bytes recibidos en la FIFO de la uart.
+    * @return # bytes consumidos
+    * @note no espera; llamar periodicamente desde el bucle principal
+    */
+   int poll();
+
+   /**
+    * procesa un byte del enlace (maquina de estados de trama).
+    * @param byte byte recibido
+    */
+   void feed(uint8_t byte);
+
+   /**
+    * tramas recibidas con CRC correcto.
+    * @return # tramas
+    */
+   uint32_t get_frames_ok();
+
+   /**
+    * tramas descartadas (CRC, LEN o timeout).
+    * @return # tramas
+    */
+   uint32_t get_frames_bad();
+
+private:
+   enum {
+      S_SOF, S_LEN0, S_LEN1, S_OP, S_CH, S_PAYLOAD, S_CRC0, S_CRC1
+   };
+   UartCore *uart;
+   DdsAwgCore *const *ch;
+   int num_ch;
+   int state;
+   int len;              // LEN de la trama en curso
+   int pos;              // bytes de PAYLOAD recibidos
+   uint8_t op;
+   uint8_t chan_idx;
+   uint8_t status;       // STATUS provisional (LEN/canal) de la trama
+   uint16_t crc;         // CRC de trama acumulado
+   uint16_t crc_rx;      // CRC recibido
+   uint8_t buf[MAX_PAYLOAD];
+   uint8_t pair[4];      // par de muestras en curso (OP_AWG_LOAD)
+   unsigned long t_last; // instante del ultimo byte (ms)
+   uint32_t frames_ok;
+   uint32_t frames_bad;
+   void header_done();
+   void payload_byte(uint8_t byte);
+   void frame_done();
+   uint8_t execute(DdsAwgCore *dds_p);
+   bool apply_reg(DdsAwgCore *dds_p, uint8_t sub, uint32_t val);
+   void reply(uint8_t st);
+   static uint16_t crc16_upd(uint16_t c, uint8_t byte);
+   static uint32_t get_u32(const uint8_t *p);
+};
+
+#endif  // _DDS_LINK_H_INCLUDED
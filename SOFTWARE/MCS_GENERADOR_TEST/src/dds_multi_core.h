@@ -0,0 +1,137 @@
+#ifndef _DDS_MULTI_CORE_H_INCLUDED
+#define _DDS_MULTI_CORE_H_INCLUDED
+#include "dds_awg_core.h"
+
+/**********************************************************************
+ * DdsMultiCore: N canales DdsAwgCore con relacion de fase garantizada
+ *  - compatible con MMIO.VHD: canal 0 = slot S5_DDS_AWG (maestro),
+ *    canal 1 = slot S6_DDS_AWG1
+ *  - el pulso SYNC del maestro se sincroniza una sola vez a clk_dds y
+ *    llega a todos los canales en el mismo ciclo
+ *  - commit(): arma el COMMIT de cada canal (CTRL.Sync Wait) y lo
+ *    aplica en todos a la vez con una unica escritura SYNC
+ *  - restart(): igual, reiniciando ademas los acumuladores; todos los
+ *    canales arrancan alineados y el desfase entre ellos es su POW
+ *  - coste por actualizacion: en cada canal los registros modificados
+ *    + CTRL + COMMIT; 1 escritura SYNC en total
+ *
+ * Ejemplo (I/Q):
+ *    DdsAwgCore *ch[2] = {&dds_i, &dds_q};
+ *    DdsMultiCore<2> iq(ch);
+ *    iq.begin();
+ *    iq.channel(1)->set_phase_mdeg(90000);
+ *    iq.restart();
+ **********************************************************************/
+template <int N>
+class DdsMultiCore {
+public:
+   /**
+    * constructor.
+    * @param chan array de N canales; chan[0] debe ser el maestro (slot 5)
+    */
+   DdsMultiCore(DdsAwgCore *const chan[N]) {
+      for (int k = 0; k < N; k++)
+         ch[k] = chan[k];
+   }
+
+   /**
+    * acceso a un canal.
+    * @param k indice del canal (0..N-1)
+    * @return puntero al canal
+    */
+   DdsAwgCore *channel(int k) {
+      return ch[k];
+   }
+
+   /**
+    * abre una transaccion en todos los canales.
+    */
+   void begin() {
+      for (int k = 0; k < N; k++)
+         ch[k]->begin();
+   }
+
+   /**
+    * aplica a la vez los cambios pendientes de todos los canales
+    * (fase continua) y cierra la transaccion.
+    * @return false si algun canal no pudo armar su COMMIT (el SYNC se
+    *         envia igualmente para no dejar armados los demas)
+    */
+   bool commit() {
+      return arm_and_sync(false);
+   }
+
+   /**
+    * aplica a la vez los cambios pendientes y reinicia los acumuladores
+    * de todos los canales en el mismo ciclo de clk_dds.
+    * @return false si algun canal no pudo armar su COMMIT
+    */
+   bool restart() {
+      return arm_and_sync(true);
+   }
+
+   /**
+    * misma frecuencia en todos los canales (un solo SYNC, fase continua).
+    * @param freq_uhz frecuencia en uHz
+    * @return frecuencia real obtenida en uHz
+    * @note el resultado del COMMIT se consulta con applied()
+    */
+   uint64_t set_freq_uhz(uint64_t freq_uhz) {
+      uint64_t f = 0;
+
+      begin();
+      for (int k = 0; k < N; k++)
+         f = ch[k]->set_freq_uhz(freq_uhz);
+      commit();
+      return f;
+   }
+
+   /**
+    * habilita/deshabilita todos los canales a la vez.
+    * @param on true para habilitar
+    * @return false si algun canal no pudo armar su COMMIT
+    */
+   bool enable(bool on) {
+      begin();
+      for (int k = 0; k < N; k++)
+         ch[k]->enable(on);
+      return commit();
+   }
+
+   /**
+    * comprueba si todos los canales han aplicado el ultimo SYNC.
+    * @return true si todos lo han aplicado
+    */
+   bool applied() {
+      for (int k = 0; k < N; k++)
+         if (!ch[k]->update_applied())
+            return false;
+      return true;
+   }
+
+   /**
+    * espera (acotada) a que todos los canales apliquen el ultimo SYNC.
+    * @return false si alguno no lo aplica en COMMIT_TIMEOUT_US
+    */
+   bool wait_applied() {
+      for (int k = 0; k < N; k++)
+         if (!ch[k]->wait_applied())
+            return false;
+      return true;
+   }
+
+private:
+   DdsAwgCore *ch[N];
+
+   bool arm_and_sync(bool phase_rst) {
+      bool ok = true;
+
+      for (int k = 0; k < N; k++)
+         if (!ch[k]->commit_on_sync(phase_rst))
+            ok = false;
+      ch[0]->sync();
+      return ok;
+   }
+};
+
+#endif  // _DDS_MULTI_CORE_H_INCLUDED
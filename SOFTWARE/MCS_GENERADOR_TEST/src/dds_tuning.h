@@ -0,0 +1,172 @@
+#ifndef _DDS_TUNING_H_INCLUDED
+#define _DDS_TUNING_H_INCLUDED
+
+#include <inttypes.h>
+#include "io_map.h"  // para DDS_SAMPLE_FREQ
+
+/**********************************************************************
+ * Aritmetica de sintonia DDS en punto fijo (sin float)
+ *  - el MicroBlaze MCS no tiene FPU: cada operacion double se resuelve
+ *    con rutinas soft-float de libgcc (miles de ciclos por retune)
+ *  - aqui todo se hace con enteros de 32/64 bits:
+ *      word = round(x * 2^32 / DIV)     (x -> FCW/POW)
+ *      x    = round(word * DIV / 2^32)  (FCW/POW -> x)
+ *  - DIV es el fondo de escala en las unidades de x, p.ej.:
+ *      f_s (frecuencia de muestreo) en uHz para el FCW, 360000 mili-grados para el POW
+ *  - el reciproco de DIV (multiply-shift) se calcula en compilacion;
+ *    la estimacion se corrige con el resto, por lo que el redondeo es
+ *    exacto (mitad hacia arriba), no una truncacion
+ **********************************************************************/
+
+/**
+ * multiplicacion 64x64 -> 128 bits con productos parciales de 32 bits
+ * (el MCS no dispone de tipos de 128 bits).
+ * @param a primer operando
+ * @param b segundo operando
+ * @param hi 64 bits altos del producto
+ * @param lo 64 bits bajos del producto
+ */
+static inline void dds_mul_u64(uint64_t a, uint64_t b, uint64_t *hi, uint64_t *lo) {
+   uint64_t a_lo = (uint32_t) a, a_hi = a >> 32;
+   uint64_t b_lo = (uint32_t) b, b_hi = b >> 32;
+   uint64_t p0 = a_lo * b_lo;
+   uint64_t p1 = a_lo * b_hi;
+   uint64_t p2 = a_hi * b_lo;
+   uint64_t p3 = a_hi * b_hi;
+   uint64_t mid = (p0 >> 32) + (uint32_t) p1 + (uint32_t) p2;
+   *lo = (mid << 32) | (uint32_t) p0;
+   *hi = p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+}
+
+/**
+ * desplaza a la derecha un valor de 128 bits (hi:lo).
+ * @param sh desplazamiento (1..127)
+ * @return 64 bits bajos del resultado
+ */
+static inline uint64_t dds_shr_u128(uint64_t hi, uint64_t lo, int sh) {
+   if (sh >= 64)
+      return hi >> (sh - 64);
+   return (hi << (64 - sh)) | (lo >> sh);
+}
+
+/**
+ * logaritmo natural de un cociente en Q16 (sin float), para calcular
+ * barridos logaritmicos: log2 por cuadrados sucesivos y cambio de base.
+ * @param num numerador (num >= den)
+ * @param den denominador (> 0)
+ * @return round-down(ln(num/den) * 2^16)
+ */
+static inline uint32_t dds_ln_q16(uint32_t num, uint32_t den) {
+   const uint64_t ONE = 1ULL << 30;  // y en Q2.30
+   uint64_t y = ((uint64_t) num << 30) / den;
+   uint32_t log2 = 0;
+
+   // parte entera: normalizar y a [1, 2)
+   while (y >= 2 * ONE) {
+      y >>= 1;
+      log2 += 1 << 16;
+   }
+   // parte fraccionaria: un bit por cada cuadrado
+   for (int b = 15; b >= 0; b--) {
+      y = (y * y) >> 30;
+      if (y >= 2 * ONE) {
+         y >>= 1;
+         log2 |= 1u << b;
+      }
+   }
+   // ln(x) = log2(x) * ln(2), ln(2) = 45426 / 2^16
+   return (uint32_t) (((uint64_t) log2 * 45426) >> 16);
+}
+
+/**
+ * conversion x <-> palabra Q0.32 (FCW/POW) para un fondo de escala DIV.
+ * @tparam DIV fondo de escala (par, < 2^62), en las unidades de x
+ */
+template <uint64_t DIV>
+class DdsScale {
+   static_assert(DIV > 1 && DIV < (1ULL << 62) && (DIV % 2) == 0,
+                 "DdsScale: DIV debe ser par y menor que 2^62");
+
+   // floor(log2(d))
+   static constexpr int log2_floor(uint64_t d) {
+      int n = -1;
+      while (d) {
+         d >>= 1;
+         n++;
+      }
+      return n;
+   }
+
+   // floor(2^p / d) mediante division larga bit a bit (solo en compilacion)
+   static constexpr uint64_t recip(uint64_t d, int p) {
+      uint64_t q = 0, r = 0;
+      for (int i = p; i >= 0; i--) {
+         r = (r << 1) | (i == p ? 1 : 0);
+         q = q << 1;
+         if (r >= d) {
+            r -= d;
+            q |= 1;
+         }
+      }
+      return q;
+   }
+
+public:
+   /** fondo de escala (word = 2^32) */
+   static constexpr uint64_t FULL_SCALE = DIV;
+   /** bit mas significativo de DIV */
+   static constexpr int DIV_LOG2 = log2_floor(DIV);
+   /** reciproco normalizado: floor(2^(64+DIV_LOG2) / DIV), en [2^63, 2^64) */
+   static constexpr uint64_t RECIP = recip(DIV, 64 + DIV_LOG2);
+   /** desplazamiento que convierte x*RECIP en x*2^32/DIV */
+   static constexpr int SHIFT = 32 + DIV_LOG2;
+
+   /**
+    * convierte x a palabra Q0.32 con redondeo exacto.
+    * @param x valor en unidades de DIV (x < 2^63 / 2^32 * DIV)
+    * @return round(x * 2^32 / DIV), modulo 2^32
+    */
+   static uint32_t to_word(uint64_t x) {
+      uint64_t hi, lo, q;
+      int64_t r;
+
+      // estimacion por defecto (error <= 1)
+      dds_mul_u64(x, RECIP, &hi, &lo);
+      q = dds_shr_u128(hi, lo, SHIFT);
+      // resto de (x*2^32 + DIV/2) - q*DIV; basta con aritmetica modulo 2^64
+      r = (int64_t) ((x << 32) + DIV / 2 - q * DIV);
+      while (r < 0) {
+         q--;
+         r += (int64_t) DIV;
+      }
+      while (r >= (int64_t) DIV) {
+         q++;
+         r -= (int64_t) DIV;
+      }
+      return (uint32_t) q;
+   }
+
+   /**
+    * convierte una palabra Q0.32 a x con redondeo.
+    * @param word FCW/POW
+    * @return round(word * DIV / 2^32)
+    */
+   static uint64_t from_word(uint32_t word) {
+      uint64_t hi, lo;
+
+      dds_mul_u64((uint64_t) word, DIV, &hi, &lo);
+      // sumar 2^31 (mitad del LSB) antes de descartar 32 bits
+      lo += 0x80000000ULL;
+      if (lo < 0x80000000ULL)
+         hi++;
+      return dds_shr_u128(hi, lo, 32);
+   }
+};
+
+/** fondos de escala del DDS (f_s = DDS_SAMPLE_FREQ MHz = LANES * f_clk) */
+typedef DdsScale<(uint64_t) DDS_SAMPLE_FREQ * 1000000ULL> DdsFreqHz;
+typedef DdsScale<(uint64_t) DDS_SAMPLE_FREQ * 1000000000ULL> DdsFreqMilliHz;
+typedef DdsScale<(uint64_t) DDS_SAMPLE_FREQ * 1000000000000ULL> DdsFreqMicroHz;
+typedef DdsScale<360000ULL> DdsPhaseMilliDeg;
+
+#endif  // _DDS_TUNING_H_INCLUDED
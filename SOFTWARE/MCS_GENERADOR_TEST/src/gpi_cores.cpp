@@ -20,6 +20,30 @@ int GpiCore::read(int bit_pos) {
    return ((int) bit_read(rd_data, bit_pos));
 }
 
+uint32_t GpiCore::read_events() {
+   return (io_read(base_addr, EVENT_REG));  // la lectura borra los flancos
+}
+
+uint32_t GpiCore::read_change_count() {
+   return (io_read(base_addr, COUNT_REG));
+}
+
+void GpiCore::clear_change_count() {
+   io_write(base_addr, COUNT_REG, 0);
+}
+
+void GpiCore::set_debounce(uint32_t us) {
+   uint32_t period;
+
+   // 3 muestras iguales = 2 periodos estables
+   period = us * SYS_CLK_FREQ / 2;
+   if (us > 0xFFFFFF / SYS_CLK_FREQ * 2)
+      period = 0x1000000;
+   if (period > 0)
+      period--;
+   io_write(base_addr, DEBOUNCE_REG, period);
+}
+
 
 
 
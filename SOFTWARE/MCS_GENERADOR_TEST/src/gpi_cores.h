@@ -10,8 +10,24 @@
  * gpi (entradas de propósito general) core driver
  *  
  * Parámetros del subsistema MMIO:
- *  - W:  # bits de entrada del registro
+ *  - W:  # bits de entrada del registro (<= 16)
  *   (bits no existentes devuelven 0's)
+ *
+ * Filtro y eventos (GPI.VHD):
+ *  - las entradas se sincronizan y se muestrean cada periodo de
+ *    set_debounce(); un bit cambia tras 3 muestras iguales, asi que se
+ *    ignoran rebotes mas cortos que un periodo (sin filtro tras reset)
+ *  - cada flanco del valor filtrado queda guardado hasta read_events(),
+ *    que los devuelve y borra en un solo acceso: una pulsacion corta no
+ *    se pierde aunque se consulte con poca frecuencia
+ *  - un contador de 32 bits cuenta los cambios del valor filtrado
+ *  - tras el reset el valor filtrado es 0: las entradas que ya estan a
+ *    1 dan un flanco de subida
+ *
+ * Ejemplo:
+ *    sw.set_debounce(10000);          // rebotes < 5 ms
+ *    ev = sw.read_events();
+ *    if (ev & GpiCore::RISE_FIELD) ...
  */
 class GpiCore {
 public:
@@ -20,7 +36,18 @@ public:
     *
     */
    enum {
-      DATA_REG = 0 /* registro de entrada de datos */
+      DATA_REG = 0,     /* registro de entrada de datos (filtrado) */
+      EVENT_REG = 1,    /* flancos {bajada, subida}; la lectura los borra */
+      COUNT_REG = 2,    /* contador de cambios; escribir lo pone a 0 */
+      DEBOUNCE_REG = 3  /* periodo de muestreo - 1, en ciclos (24 bits) */
+   };
+   /**
+    * campos del registro de eventos
+    *
+    */
+   enum {
+      RISE_FIELD = 0x0000ffff,  /* bits 15..0: flancos de subida */
+      FALL_FIELD = 0xffff0000   /* bits 31..16: flancos de bajada */
    };
    /**
     * constructor.
@@ -45,6 +72,30 @@ public:
     */
    int read(int bit_pos);
 
+   /**
+    * lee y borra los flancos guardados desde la ultima llamada
+    * @return {bajada[15:0], subida[15:0]} (ver RISE_FIELD/FALL_FIELD)
+    */
+   uint32_t read_events();
+
+   /**
+    * lee el contador de cambios del valor filtrado
+    * @return # cambios (modulo 2^32)
+    */
+   uint32_t read_change_count();
+
+   /**
+    * pone a 0 el contador de cambios
+    */
+   void clear_change_count();
+
+   /**
+    * configura el filtro antirrebote: se muestrea cada us/2 y se exige
+    * el mismo valor en 3 muestras (estable durante us)
+    * @param us tiempo estable en microsegundos (0: sin filtro, max 268 ms)
+    */
+   void set_debounce(uint32_t us);
+
 private:
    uint32_t base_addr;
 };
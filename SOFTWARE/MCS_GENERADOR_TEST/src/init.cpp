@@ -1,18 +1,34 @@
 
 #include "init.h"
+#include "trace.h"
 
 TimerCore _sys_timer(get_slot_addr(BRIDGE_BASE, S0_TIMER));
 // UartCore uart no utilizada en Zybo Z7
 
 
-// Actual system time en microsegundos
+// timer del sistema (alarmas)
+TimerCore *sys_timer() {
+return (&_sys_timer);
+}
+
+// Actual system time en ciclos de reloj (SYS_CLK_FREQ)
+uint64_t now_tick() {
+return (_sys_timer.read_tick());
+}
+
+// 32 bits bajos del system time en ciclos (un acceso; intervalos < 34 s)
+uint32_t now_tick32() {
+return (_sys_timer.read_tick32());
+}
+
+// Actual system time en microsegundos (reciproco, sin division)
 unsigned long now_us() {
 return ((unsigned long) _sys_timer.read_time());
 }
 
-// Actual system time enmilisegundos
+// Actual system time enmilisegundos (reciproco, sin division)
 unsigned long now_ms() {
-return ((unsigned long) _sys_timer.read_time() / 1000);
+return ((unsigned long) _sys_timer.read_time_ms());
 }
 
 // pausa por t microsegundos
@@ -27,10 +43,11 @@ t));
 }
 
 // debug activado
-// envía por UART un mensage de 1-linea: msg + 2 numeros en dec/hex format
+// guarda msg + 2 numeros en el ring de trace (ver trace.h); el texto
+// se genera en trace_dump()
 
 void debug_on(const char *str, int n1, int n2) {
-   // UART no disponible en Zybo Z7
+   trace_put(str, n1, n2);
 }
 
 void debug_off() {
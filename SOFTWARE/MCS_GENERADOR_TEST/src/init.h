@@ -8,11 +8,16 @@
 
 
 
+// timer del sistema (slot S0): para las alarmas (TimerCore::set_alarm...)
+TimerCore *sys_timer();
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 //timing functions
+uint64_t now_tick();
+uint32_t now_tick32();
 unsigned long now_us();
 unsigned long now_ms();
 void sleep_us(unsigned long int t);
@@ -24,7 +29,8 @@ void sleep_ms(unsigned long int t);
  *  - _DEBUG debe ser definido en el fichero de forma individual
  *  - reemplazado con debug_off() cuando _DEBUG no está defineda
  *  - reemplazado con debug_on() cuando _DEBUG está defineda
- *  - debug_on() imprime un mensaje de una línea (un string y 2 numeros)
+ *  - debug_on() guarda un registro (un string y 2 numeros) en el ring
+ *    de trace; se imprime con trace_dump() (trace.h)
  *
  *********************************************************************/
 
@@ -35,7 +41,7 @@ void sleep_ms(unsigned long int t);
 void debug_off();
 
 /**
- * imprime un mensaje de una linea (string más 2 numeros).
+ * registra un mensaje de una linea (string más 2 numeros).
  * @param str un string
  * @param n1 primer número
  * @param n2 segundo número
@@ -10,8 +10,14 @@ extern "C" {
  ***********************************************************/
 // system clock rate in MHz; used for timer, uart, spi
 #define SYS_CLK_FREQ 125
-// DDS clock rate in MHz; used for FCW calculation (f_out = fcw * DDS_CLK_FREQ / 2^32)
+// DDS clock rate in MHz (clk_dds); used for sweep dwell times
 #define DDS_CLK_FREQ 165
+// DDS samples per clk_dds cycle (LANES generic of dds_awg_slot); must match
+// DDS_LANES in IO_MAP.VHD. Only 1 is built: mmio dac_out is 14 bits and
+// LANES > 1 has no serializer to the DAC (mmio asserts DDS_LANES = 1)
+#define DDS_LANES 1
+// DDS sample rate in MHz; used for FCW calculation (f_out = fcw * DDS_SAMPLE_FREQ / 2^32)
+#define DDS_SAMPLE_FREQ (DDS_CLK_FREQ * DDS_LANES)
 
 //io base address for microBlaze MCS
 #define BRIDGE_BASE 0xc0000000
@@ -24,7 +30,7 @@ extern "C" {
 #define S3_UART       3
 #define S4_SPI        4
 #define S5_DDS_AWG    5
-#define S6_USER       6
+#define S6_DDS_AWG1   6   // segundo canal DDS, sincronizado con S5
 #define S7_USER       7
 #define S8_USER       8
 #define S9_USER       9
@@ -8,12 +8,29 @@
 extern "C" {
 #endif
 
+#ifdef _HOST_IO
+// compilacion en el host (pruebas y benchmarks, -D_HOST_IO): cada acceso
+// va a un bus simulado que implementa host_io_read()/host_io_write()
+// (ver test/host_bus.h)
+uint32_t host_io_read(uint32_t addr);
+void host_io_write(uint32_t addr, uint32_t data);
+
+#define io_read(base_addr, offset) \
+(host_io_read((uint32_t)((base_addr) + 4*(offset))))
+
+#define io_write(base_addr, offset, data) \
+(host_io_write((uint32_t)((base_addr) + 4*(offset)), (uint32_t)(data)))
+
+#else
+
 #define io_read(base_addr, offset) \
 (*(volatile uint32_t *)((base_addr) + 4*(offset)))
 
 #define io_write(base_addr, offset, data) \
 (*(volatile uint32_t *)((base_addr) + 4*(offset)) = (data))
 
+#endif // _HOST_IO
+
 #define get_slot_addr(base, slot) \
 ((uint32_t)((base) + (slot)*32*4))
 
@@ -9,107 +9,179 @@
  *******************************************************************/
 
 //#define _DEBUG
+// benchmarks de arranque (bench_suite.h): -D_BENCH en todo el proyecto
 
 #include "init.h"
 #include "gpi_cores.h"
 #include "gpo_cores.h"
 #include "spi_core.h"
+#include "uart_core.h"
+#include "dds_awg_core.h"
+#include "dds_multi_core.h"
+#include "dds_link.h"
+#include "trace.h"
+#include "scheduler.h"
+#include "bench_suite.h"
+#include "spi_flash.h"
+#include "wave_store.h"
+
+// instancias de perifericos
+GpoCore led(get_slot_addr(BRIDGE_BASE, S1_LED));
+GpiCore sw(get_slot_addr(BRIDGE_BASE, S2_SW));
+SpiCore spi(get_slot_addr(BRIDGE_BASE, S4_SPI));
+UartCore uart(get_slot_addr(BRIDGE_BASE, S3_UART));
+DdsAwgCore dds(get_slot_addr(BRIDGE_BASE, S5_DDS_AWG));
+DdsAwgCore dds1(get_slot_addr(BRIDGE_BASE, S6_DDS_AWG1));
+DdsAwgCore *const dds_ch[2] = {&dds, &dds1};
+DdsMultiCore<2> dds_iq(dds_ch);
+DdsLink link(&uart, dds_ch, 2);
+SpiFlash flash(&spi, 1);                // flash SPI NOR en ss 1
+WaveStore wstore(&flash, 0x1000000);    // 16 MB (direcciones de 3 bytes)
+Scheduler sched;
+int sw_state = 0;          // switches 2..0 (sw_task)
 
 /*******************************************************************
- * Parpadea 5 veces todos los LEDs.
+ * Tareas del planificador (scheduler.h): cada llamada hace un paso y
+ * retorna; el periodo lo fija el planificador, sin sleep_ms().
+ * LEDs compartidos: led 3 = latido, leds 2..0 = secuencia o switches.
+ *******************************************************************/
+
+/*******************************************************************
+ * Latido: conmuta el led 3 (cada 1 s, periodo del timer).
  * Permite chequear el timer (basado en la SYS_CLK_FREQ)
- * @param led_p puntero a la instancia GpoCore (led)
+ * @param arg puntero a la instancia GpoCore (led)
  */
-void timer_check(GpoCore *led_p) {
-   int i;
+void timer_task(void *arg) {
+   static int on = 0;
+   GpoCore *led_p = (GpoCore *) arg;
 
-   for (i = 0; i < 5; i++) {
-      led_p->write(0x0F);     // 4 LEDs encendidos
-      sleep_ms(1000);
-      led_p->write(0x00);
-      sleep_ms(1000);
-   }
+   on = !on;
+   led_p->write(on, 3);
 }
 
 /*******************************************************************
- * Chequeo individual de led
- * @param led_p puntero a la instancia GpoCore (led)
- * @param n numero de LEDs
+ * Chequeo individual de led: enciende por turno los leds 0..2 (cada
+ * 200 ms) mientras no haya switches activados.
+ * @param arg puntero a la instancia GpoCore (led)
  */
-void led_check(GpoCore *led_p, int n) {
-   int i;
-
-   for (i = 0; i < n; i++) {
-      led_p->write(1, i);
-      sleep_ms(200);
-      led_p->write(0, i);
-      sleep_ms(200);
-   }
+void led_task(void *arg) {
+   static int n = 0;
+   GpoCore *led_p = (GpoCore *) arg;
+
+   if (sw_state != 0)
+      return;
+   for (int i = 0; i < 3; i++)
+      led_p->write(i == n, i);
+   n = (n == 2) ? 0 : n + 1;
 }
 
 /*******************************************************************
- * Parpadea LEDs de acuerdo a los switches activados.
- * @param led_p puntero a la instancia led
- * @param sw_p puntero a la instancia GpiCore (switch)
+ * Lee los switches y parpadea los leds 0..2 con su valor (cada 50 ms).
+ * Los cambios llegan filtrados y guardados en el core (read_events),
+ * asi que se registran aunque duren menos que el periodo de la tarea.
+ * @param arg puntero a la instancia GpiCore (switch)
  */
-void sw_check(GpoCore *led_p, GpiCore *sw_p) {
-   int i, s;
-
-   s = sw_p->read();
-   for (i = 0; i < 30; i++) {
-      led_p->write(s);
-      sleep_ms(50);
-      led_p->write(0);
-      sleep_ms(50);
-   }
+void sw_task(void *arg) {
+   static int on = 0;
+   GpiCore *sw_p = (GpiCore *) arg;
+   uint32_t ev;
+   int i;
+
+   ev = sw_p->read_events();
+   if (ev != 0)
+      trace(TRACE_APP, "sw eventos", ev, sw_p->read_change_count());
+   sw_state = sw_p->read() & 0x07;
+   if (sw_state == 0)
+      return;
+   on = !on;
+   for (i = 0; i < 3; i++)
+      led.write(on && ((sw_state >> i) & 1), i);
 }
 
 /*******************************************************************
- * Test basico SPI: envia un byte y lee la respuesta.
- * Enciende led[0] si el controlador SPI responde (ready).
- * @param spi_p puntero a la instancia SpiCore
- * @param led_p puntero a la instancia GpoCore (led)
+ * Test basico SPI: envia un byte y lee la respuesta (cada 2 s).
+ * El resultado se guarda en el trace (los leds los usan las otras
+ * tareas).
+ * @param arg puntero a la instancia SpiCore (configurada en main)
  */
-void spi_check(SpiCore *spi_p, GpoCore *led_p) {
+void spi_task(void *arg) {
+   SpiCore *spi_p = (SpiCore *) arg;
    uint8_t rx_data;
 
-   // configurar SPI: modo 0 (cpol=0, cpha=0), ~100 KHz
-   spi_p->set_freq(100);
-   spi_p->set_mode(0, 0);
-
-   // activar slave 0
    spi_p->assert_ss(0);
-
-   // enviar byte de prueba
    rx_data = spi_p->transfer(0xA5);
-
-   // desactivar slave 0
    spi_p->deassert_ss(0);
+   trace(TRACE_APP, "spi rx", rx_data, 0);
+}
 
-   // indicar con LEDs que el test se ha completado
-   // muestra los 4 bits bajos del dato recibido
-   led_p->write(rx_data & 0x0F);
-   sleep_ms(2000);
-   led_p->write(0x00);
+/*******************************************************************
+ * Informe periodico del planificador por UART (cada 10 s).
+ * @param arg puntero a la instancia Scheduler
+ */
+void report_task(void *arg) {
+   Scheduler *sched_p = (Scheduler *) arg;
+
+   sched_p->report(&uart);
 }
 
+/*******************************************************************
+ * Arranque I/Q: dos canales a 1 kHz, Q adelantado 90 grados, con los
+ * acumuladores reiniciados en el mismo ciclo de clk_dds (un SYNC).
+ * @param iq_p puntero a la instancia DdsMultiCore<2>
+ * @param uart_p puntero a la instancia UartCore
+ */
+bool dds_iq_start(DdsMultiCore<2> *iq_p, UartCore *uart_p) {
+   uint64_t t0, t;
+
+   t0 = now_tick();
+   iq_p->begin();
+   iq_p->channel(0)->set_freq_uhz(1000000000ULL);
+   iq_p->channel(1)->set_freq_uhz(1000000000ULL);
+   iq_p->channel(0)->set_phase_mdeg(0);
+   iq_p->channel(1)->set_phase_mdeg(90000);
+   iq_p->channel(0)->enable(true);
+   iq_p->channel(1)->enable(true);
+   if (!iq_p->restart() || !iq_p->wait_applied()) {
+      uart_p->disp("dds I/Q start: el SYNC no se aplica\n\r");
+      return false;
+   }
+   t = now_tick() - t0;
+
+   uart_p->disp("dds I/Q start (ciclos hasta aplicado): ");
+   uart_p->disp((int) t);
+   uart_p->disp("\n\r");
+   return true;
+}
 
 /*******************************************************************/
 /*         MAIN                        */
 /*******************************************************************/
 
-// instancias de perifericos
-GpoCore led(get_slot_addr(BRIDGE_BASE, S1_LED));
-GpiCore sw(get_slot_addr(BRIDGE_BASE, S2_SW));
-SpiCore spi(get_slot_addr(BRIDGE_BASE, S4_SPI));
-
 int main() {
 
+#ifdef _BENCH
+   bench_suite(&dds, &spi, &flash, &wstore, &uart);
+#endif
+   dds_iq_start(&dds_iq, &uart);
+   trace_dump(&uart);
+
+   // configurar SPI: modo 0 (cpol=0, cpha=0), ~100 KHz
+   spi.set_freq(100);
+   spi.set_mode(0, 0);
+
+   // antirrebote de los switches: 10 ms estables
+   sw.set_debounce(10000);
+
+   sched.add_periodic("timer", timer_task, &led, 1000000, 0);
+   sched.add_periodic("led", led_task, &led, 200000, 0);
+   sched.add_periodic("sw", sw_task, &sw, 50000, 0);
+   sched.add_periodic("spi", spi_task, &spi, 2000000, 0);
+   sched.add_periodic("report", report_task, &sched, 10000000, 10000000);
+
    while (1) {
-      timer_check(&led);
-      led_check(&led, 4);       // 4 LEDs en Zybo Z7
-      sw_check(&led, &sw);
-      spi_check(&spi, &led);
+      sched.run();              // tareas vencidas
+      uart.poll();              // drena el ring TX de la uart
+      link.poll();              // comandos del host
    } //while
 } //main
 
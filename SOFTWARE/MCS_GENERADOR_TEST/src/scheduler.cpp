@@ -0,0 +1,220 @@
+#include "scheduler.h"
+#include "uart_core.h"
+
+Scheduler::Scheduler() {
+   for (int i = 0; i < MAX_TASKS; i++) {
+      task[i].heap_pos = -1;
+      task[i].gen = 0;
+   }
+   heap_n = 0;
+}
+
+Scheduler::~Scheduler() {
+}
+
+int Scheduler::add_periodic(const char *name, TaskFn fn, void *arg, uint32_t period_us,
+                            uint32_t phase_us) {
+   if (period_us == 0)
+      period_us = 1;
+   // en ticks de 32 bits desbordaria o romperia la comparacion modulo 2^32
+   if (period_us > MAX_DELAY_US || phase_us > MAX_DELAY_US)
+      return -1;
+   return add(name, fn, arg, period_us * SYS_CLK_FREQ, phase_us * SYS_CLK_FREQ);
+}
+
+int Scheduler::add_oneshot(const char *name, TaskFn fn, void *arg, uint32_t delay_us) {
+   if (delay_us > MAX_DELAY_US)
+      return -1;
+   return add(name, fn, arg, 0, delay_us * SYS_CLK_FREQ);
+}
+
+void Scheduler::cancel(int id) {
+   if (id < 0 || id >= MAX_TASKS || task[id].heap_pos < 0)
+      return;
+   heap_remove(task[id].heap_pos);
+}
+
+int Scheduler::run() {
+   Task *t;
+   uint32_t now, start, late, rt, gen;
+   int id, n = 0;
+
+   // como mucho una ronda de MAX_TASKS: una tarea con periodo menor
+   // que su tiempo de ejecucion no puede acaparar run()
+   while (heap_n > 0 && n < MAX_TASKS) {
+      id = heap[0];
+      t = &task[id];
+      start = now_tick32();
+      late = start - t->deadline;
+      if ((int32_t) late < 0)
+         break;  // la mas proxima aun no ha vencido
+      // replanificar antes de ejecutar: la tarea puede cancelarse
+      if (t->period == 0)
+         heap_remove(0);
+      else {
+         t->deadline += t->period;
+         while ((int32_t) (start - t->deadline) >= 0) {
+            t->deadline += t->period;
+            t->st.overruns++;
+         }
+         sift_down(0);
+      }
+      gen = t->gen;
+      t->fn(t->arg);
+      now = now_tick32();
+      n++;
+      // si fn() libero su hueco y un add_*() lo reutilizo, las
+      // estadisticas ya son de otra tarea: no se tocan
+      if (t->gen != gen)
+         continue;
+      rt = now - start;
+      t->st.runs++;
+      t->st.rt_sum += rt;
+      t->st.late_sum += late;
+      if (rt < t->st.rt_min)
+         t->st.rt_min = rt;
+      if (rt > t->st.rt_max)
+         t->st.rt_max = rt;
+      if (late > t->st.late_max)
+         t->st.late_max = late;
+   }
+   return n;
+}
+
+int32_t Scheduler::idle_ticks() {
+   int32_t d;
+
+   if (heap_n == 0)
+      return -1;
+   d = (int32_t) (task[heap[0]].deadline - now_tick32());
+   return (d < 0) ? 0 : d;
+}
+
+const Scheduler::Stats *Scheduler::get_stats(int id) {
+   if (id < 0 || id >= MAX_TASKS)
+      return 0;
+   return &task[id].st;
+}
+
+void Scheduler::clear_stats() {
+   for (int i = 0; i < MAX_TASKS; i++) {
+      task[i].st.runs = 0;
+      task[i].st.overruns = 0;
+      task[i].st.rt_min = 0xFFFFFFFF;
+      task[i].st.rt_max = 0;
+      task[i].st.rt_sum = 0;
+      task[i].st.late_max = 0;
+      task[i].st.late_sum = 0;
+   }
+}
+
+void Scheduler::report(UartCore *uart_p) {
+   const Stats *s;
+   int i;
+
+   // formateo fuera de la ruta critica: aqui se admiten divisiones
+   uart_p->disp("sched: tarea  runs  overruns  rt min/med/max  jitter med/max (us)\n\r");
+   for (i = 0; i < MAX_TASKS; i++) {
+      if (task[i].heap_pos < 0)
+         continue;
+      s = &task[i].st;
+      uart_p->disp(" ");
+      uart_p->disp(task[i].name);
+      uart_p->disp("  ");
+      uart_p->disp((int) s->runs);
+      uart_p->disp("  ");
+      uart_p->disp((int) s->overruns);
+      if (s->runs > 0) {
+         uart_p->disp("  ");
+         uart_p->disp_fixed((int) ((uint64_t) s->rt_min * 1000 / SYS_CLK_FREQ), 3);
+         uart_p->disp("/");
+         uart_p->disp_fixed((int) (s->rt_sum * 1000 / SYS_CLK_FREQ / s->runs), 3);
+         uart_p->disp("/");
+         uart_p->disp_fixed((int) ((uint64_t) s->rt_max * 1000 / SYS_CLK_FREQ), 3);
+         uart_p->disp("  ");
+         uart_p->disp_fixed((int) (s->late_sum * 1000 / SYS_CLK_FREQ / s->runs), 3);
+         uart_p->disp("/");
+         uart_p->disp_fixed((int) ((uint64_t) s->late_max * 1000 / SYS_CLK_FREQ), 3);
+      }
+      uart_p->disp("\n\r");
+   }
+}
+
+// ---- Helpers privados: alta y monticulo de plazos ----
+int Scheduler::add(const char *name, TaskFn fn, void *arg, uint32_t period, uint32_t delay) {
+   Task *t;
+   int id;
+
+   for (id = 0; id < MAX_TASKS; id++) {
+      if (task[id].heap_pos < 0)
+         break;
+   }
+   if (id == MAX_TASKS)
+      return -1;
+   t = &task[id];
+   t->gen++;
+   t->name = name;
+   t->fn = fn;
+   t->arg = arg;
+   t->period = period;
+   t->deadline = now_tick32() + delay;
+   t->st.runs = 0;
+   t->st.overruns = 0;
+   t->st.rt_min = 0xFFFFFFFF;
+   t->st.rt_max = 0;
+   t->st.rt_sum = 0;
+   t->st.late_max = 0;
+   t->st.late_sum = 0;
+   heap[heap_n] = id;
+   t->heap_pos = heap_n;
+   heap_n++;
+   sift_up(heap_n - 1);
+   return id;
+}
+
+// orden por plazo modulo 2^32 (todos los plazos a < 2^31 ticks entre si)
+bool Scheduler::earlier(int a, int b) {
+   return (int32_t) (task[heap[a]].deadline - task[heap[b]].deadline) < 0;
+}
+
+void Scheduler::heap_swap(int i, int j) {
+   int tmp = heap[i];
+
+   heap[i] = heap[j];
+   heap[j] = tmp;
+   task[heap[i]].heap_pos = i;
+   task[heap[j]].heap_pos = j;
+}
+
+void Scheduler::sift_up(int i) {
+   while (i > 0 && earlier(i, (i - 1) / 2)) {
+      heap_swap(i, (i - 1) / 2);
+      i = (i - 1) / 2;
+   }
+}
+
+void Scheduler::sift_down(int i) {
+   int c;
+
+   while ((c = 2 * i + 1) < heap_n) {
+      if (c + 1 < heap_n && earlier(c + 1, c))
+         c++;
+      if (!earlier(c, i))
+         break;
+      heap_swap(i, c);
+      i = c;
+   }
+}
+
+void Scheduler::heap_remove(int i) {
+   int id = heap[i];
+
+   heap_n--;
+   if (i != heap_n) {
+      heap[i] = heap[heap_n];
+      task[heap[i]].heap_pos = i;
+      sift_down(i);
+      sift_up(i);
+   }
+   task[id].heap_pos = -1;
+}
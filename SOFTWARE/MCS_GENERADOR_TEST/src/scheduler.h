@@ -0,0 +1,140 @@
+#ifndef _SCHEDULER_H_INCLUDED
+#define _SCHEDULER_H_INCLUDED
+#include "init.h"
+
+class UartCore;
+
+/**********************************************************************
+ * Scheduler: planificador cooperativo por plazos (deadline)
+ *  - MAX_TASKS huecos estaticos; un monticulo binario (min-heap) de
+ *    plazos ordena las tareas, la mas proxima en la raiz
+ *  - run() no espera: ejecuta las tareas vencidas y retorna; se llama
+ *    en el bucle principal junto al resto del trabajo de fondo
+ *  - tiempos en ticks de 32 bits (now_tick32(), un acceso al bus);
+ *    comparacion modulo 2^32, periodos y retardos < 2^31 ticks (17 s):
+ *    add_periodic()/add_oneshot() rechazan valores mayores que
+ *    MAX_DELAY_US
+ *  - periodicas sin deriva: el plazo siguiente es el anterior + periodo;
+ *    si una tarea se retrasa mas de un periodo se saltan los plazos
+ *    perdidos (overruns) en lugar de ejecutarla en rafaga
+ *  - estadisticas por tarea: ejecuciones, tiempo de ejecucion
+ *    (min/medio/max) y jitter de arranque (retraso sobre el plazo)
+ *
+ * Ejemplo:
+ *    Scheduler sched;
+ *    sched.add_periodic("led", led_task, &led, 200000, 0);
+ *    while (1) {
+ *       sched.run();
+ *       uart.poll();
+ *    }
+ **********************************************************************/
+class Scheduler {
+public:
+   typedef void (*TaskFn)(void *arg);
+
+   static const int MAX_TASKS = 8;
+   // periodo/retardo maximo: 2^31 - 1 ticks (17 s a 125 MHz)
+   static const uint32_t MAX_DELAY_US = 0x7FFFFFFF / SYS_CLK_FREQ;
+
+   /**
+    * estadisticas de una tarea (ticks de SYS_CLK_FREQ)
+    */
+   struct Stats {
+      uint32_t runs;       /**< ejecuciones */
+      uint32_t overruns;   /**< plazos perdidos (saltados) */
+      uint32_t rt_min;     /**< tiempo de ejecucion minimo */
+      uint32_t rt_max;     /**< tiempo de ejecucion maximo */
+      uint64_t rt_sum;     /**< suma de tiempos de ejecucion */
+      uint32_t late_max;   /**< retraso maximo sobre el plazo (jitter) */
+      uint64_t late_sum;   /**< suma de retrasos */
+   };
+
+   Scheduler();
+   ~Scheduler();
+
+   /**
+    * crea una tarea periodica.
+    * @param name nombre (literal) para report()
+    * @param fn funcion de la tarea
+    * @param arg argumento de fn
+    * @param period_us periodo en us (1..MAX_DELAY_US)
+    * @param phase_us retardo hasta la primera ejecucion en us
+    *        (<= MAX_DELAY_US)
+    * @return id de la tarea, -1 si no quedan huecos o un tiempo
+    *         excede MAX_DELAY_US
+    */
+   int add_periodic(const char *name, TaskFn fn, void *arg, uint32_t period_us,
+                    uint32_t phase_us);
+
+   /**
+    * crea una tarea de un solo disparo; el hueco se libera al ejecutarla.
+    * @param name nombre (literal) para report()
+    * @param fn funcion de la tarea
+    * @param arg argumento de fn
+    * @param delay_us retardo en us (<= MAX_DELAY_US)
+    * @return id de la tarea, -1 si no quedan huecos o delay_us excede
+    *         MAX_DELAY_US
+    */
+   int add_oneshot(const char *name, TaskFn fn, void *arg, uint32_t delay_us);
+
+   /**
+    * elimina una tarea (no hace nada si el id no esta activo).
+    * @param id id devuelto por add_periodic()/add_oneshot()
+    */
+   void cancel(int id);
+
+   /**
+    * ejecuta las tareas cuyo plazo ha vencido, por orden de plazo.
+    * @return # tareas ejecutadas
+    * @note no espera
+    */
+   int run();
+
+   /**
+    * ticks hasta el proximo plazo.
+    * @return ticks (0 si ya ha vencido, -1 si no hay tareas)
+    */
+   int32_t idle_ticks();
+
+   /**
+    * lee las estadisticas de una tarea.
+    * @param id id de la tarea
+    * @return puntero a las estadisticas (0 si el id no es valido)
+    */
+   const Stats *get_stats(int id);
+
+   /**
+    * reinicia las estadisticas de todas las tareas.
+    */
+   void clear_stats();
+
+   /**
+    * imprime una tabla con las estadisticas de las tareas activas
+    * (tiempos en us).
+    * @param uart_p uart de salida
+    */
+   void report(UartCore *uart_p);
+
+private:
+   struct Task {
+      const char *name;
+      TaskFn fn;
+      void *arg;
+      uint32_t deadline;   // tick del proximo plazo
+      uint32_t period;     // ticks; 0 = un solo disparo
+      int heap_pos;        // posicion en heap (-1: hueco libre)
+      uint32_t gen;        // altas del hueco (detecta su reutilizacion)
+      Stats st;
+   };
+   Task task[MAX_TASKS];
+   int heap[MAX_TASKS];    // ids ordenados por plazo
+   int heap_n;
+   int add(const char *name, TaskFn fn, void *arg, uint32_t period, uint32_t delay);
+   bool earlier(int a, int b);
+   void heap_swap(int i, int j);
+   void sift_up(int i);
+   void sift_down(int i);
+   void heap_remove(int i);
+};
+
+#endif // _SCHEDULER_H_INCLUDED
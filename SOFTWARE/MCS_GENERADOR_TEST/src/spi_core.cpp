@@ -6,8 +6,8 @@
  **********************************************************************/
 SpiCore::SpiCore(uint32_t core_base_addr) {
    base_addr = core_base_addr;
-   // ctrl por defecto: cpol=0, cpha=0, dvsr=256 (~195 KHz con 100 MHz)
-   ctrl_data = 0x00000100;
+   // ctrl por defecto: 8 bits, cpol=0, cpha=0, dvsr=256 (~243 KHz)
+   ctrl_data = 0x07000100;
    ss_n_data = 0x00000003;  // todos los ss desactivados (activo bajo)
    io_write(base_addr, CTRL_REG, ctrl_data);
    io_write(base_addr, SS_REG, ss_n_data);
@@ -23,19 +23,29 @@ void SpiCore::set_freq(int freq) {
    dvsr = (SYS_CLK_FREQ * 1000) / (2 * freq) - 1;
    if (dvsr < 0)
       dvsr = 0;
-   // preservar cpol/cpha (bits 17:16), actualizar dvsr (bits 15:0)
-   ctrl_data = (ctrl_data & 0x00030000) | (dvsr & 0x0000FFFF);
+   // preservar ancho/rx_dis/cpol/cpha, actualizar dvsr (bits 15:0)
+   ctrl_data = (ctrl_data & 0xFFFF0000) | (dvsr & 0x0000FFFF);
    io_write(base_addr, CTRL_REG, ctrl_data);
 }
 
 void SpiCore::set_mode(int cpol, int cpha) {
    // cpol en bit 16, cpha en bit 17
-   ctrl_data = (ctrl_data & 0x0000FFFF)
+   ctrl_data = (ctrl_data & 0xFFFCFFFF)
              | ((cpol & 0x01) << 16)
              | ((cpha & 0x01) << 17);
    io_write(base_addr, CTRL_REG, ctrl_data);
 }
 
+void SpiCore::set_width(int bits) {
+   if (bits < 1)
+      bits = 1;
+   if (bits > 32)
+      bits = 32;
+   // nbits = ancho - 1 en bits 28:24
+   ctrl_data = (ctrl_data & ~NBITS_FIELD) | ((uint32_t) (bits - 1) << 24);
+   io_write(base_addr, CTRL_REG, ctrl_data);
+}
+
 void SpiCore::assert_ss(int n) {
    bit_clear(ss_n_data, n);  // activo bajo: clear = activar
    io_write(base_addr, SS_REG, ss_n_data);
@@ -47,17 +57,84 @@ void SpiCore::deassert_ss(int n) {
 }
 
 uint8_t SpiCore::transfer(uint8_t data) {
-   // espera a que el controlador este listo
-   while (!ready()) {}
-   // escribe dato, lo que arranca la transferencia
+   uint32_t rd_word;
+
+   // encola el dato, lo que arranca la transferencia
    io_write(base_addr, WR_DATA_REG, (uint32_t) data);
-   // espera a que termine
+   // espera al byte recibido; la lectura lo extrae de la rx FIFO
+   do {
+      rd_word = io_read(base_addr, RX_POP_REG);
+   } while (!(rd_word & RX_VALID_FIELD));
+   return ((uint8_t) (rd_word & RX_DATA_FIELD));
+}
+
+void SpiCore::transfer(const uint8_t *tx, uint8_t *rx, size_t n) {
+   burst(tx, rx, n, 0);
+}
+
+void SpiCore::read(uint8_t *rx, size_t n, uint8_t fill) {
+   burst(0, rx, n, fill);
+}
+
+void SpiCore::write(const uint8_t *tx, size_t n) {
+   uint32_t rd_word;
+   size_t i, room;
+
+   // sin recepcion no hay que extraer nada: solo se rellena la tx FIFO
+   io_write(base_addr, CTRL_REG, ctrl_data | RX_DIS_FIELD);
+   i = 0;
+   while (i < n) {
+      rd_word = io_read(base_addr, RD_DATA_REG);
+      room = FIFO_DEPTH - ((rd_word & TX_LEVEL_FIELD) >> 24);
+      while (room > 0 && i < n) {
+         io_write(base_addr, WR_DATA_REG, (uint32_t) tx[i]);
+         i++;
+         room--;
+      }
+   }
+   // rx_dis solo se retira con el controlador parado
    while (!ready()) {}
-   // lee dato recibido (bits 7:0)
-   return ((uint8_t) io_read(base_addr, RD_DATA_REG) & 0xFF);
+   io_write(base_addr, CTRL_REG, ctrl_data);
 }
 
 bool SpiCore::ready() {
    // bit 8 del registro de lectura indica ready
-   return ((io_read(base_addr, RD_DATA_REG) & 0x100) != 0);
+   return ((io_read(base_addr, RD_DATA_REG) & READY_FIELD) != 0);
+}
+
+void SpiCore::start(uint32_t word) {
+   // encolar basta: el controlador la arranca en cuanto queda libre
+   io_write(base_addr, WR_DATA_REG, word);
+}
+
+bool SpiCore::busy() {
+   return (!ready());
+}
+
+uint32_t SpiCore::finish() {
+   // la palabra entra en la rx FIFO al acabar de desplazarse
+   while (io_read(base_addr, RD_DATA_REG) & RX_EMPTY_FIELD) {}
+   return (io_read(base_addr, RX_WORD_REG));
+}
+
+// rafaga full duplex: hasta FIFO_DEPTH bytes en vuelo (tx FIFO +
+// registro de desplazamiento + rx FIFO), una lectura por byte recibido
+void SpiCore::burst(const uint8_t *tx, uint8_t *rx, size_t n, uint8_t fill) {
+   uint32_t rd_word;
+   size_t sent, recv;
+
+   sent = 0;
+   recv = 0;
+   while (recv < n) {
+      while (sent < n && sent - recv < FIFO_DEPTH) {
+         io_write(base_addr, WR_DATA_REG, (uint32_t) (tx ? tx[sent] : fill));
+         sent++;
+      }
+      rd_word = io_read(base_addr, RX_POP_REG);
+      if (rd_word & RX_VALID_FIELD) {
+         if (rx)
+            rx[recv] = (uint8_t) (rd_word & RX_DATA_FIELD);
+         recv++;
+      }
+   }
 }
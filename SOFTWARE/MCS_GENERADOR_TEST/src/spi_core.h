@@ -1,16 +1,40 @@
 #ifndef _SPI_CORE_H_INCLUDED
 #define _SPI_CORE_H_INCLUDED
 #include "init.h"
+#include <stddef.h>  // size_t
 
 /**********************************************************************
  * spi_core driver
  *  - compatible con spi_core.vhd (wrapper de spi_controller.vhd)
+ *  - palabras de 1 a 32 bits (set_width(), 8 por defecto), msb primero
+ *  - FIFOs tx/rx de FIFO_DEPTH palabras: el controlador encadena las
+ *    palabras de la tx FIFO sin huecos en sclk; cada palabra recibida
+ *    entra en la rx FIFO (salvo con rx_dis)
+ *  - las rafagas de bytes (transfer/write/read) requieren ancho <= 8 y
+ *    mantienen como mucho FIFO_DEPTH bytes en vuelo, asi que ninguna
+ *    FIFO desborda; todas las funciones extraen de la rx FIFO
+ *    exactamente las palabras que encolan
+ *  - start()/busy()/finish(): transferencia asincrona de una palabra;
+ *    la CPU prepara la siguiente mientras la actual se desplaza
+ *
+ * Ejemplo (DAC de 24 bits):
+ *    spi.set_width(24);
+ *    spi.assert_ss(0);
+ *    spi.start(word);
+ *    next = calcula_siguiente();   // solapado con el envio
+ *    spi.finish();
+ *    spi.deassert_ss(0);
  *
  * Mapa de registros:
- *  - reg 0 (lectura):  {23'b0, ready, dout[7:0]}
+ *  - reg 0 (lectura):  {3'b0, tx_level[4:0], 3'b0, rx_level[4:0], 5'b0,
+ *                       rx_empty, tx_full, ready, rx_dout[7:0]}
  *  - reg 1 (escritura): ss_n (slave selects, activo bajo)
- *  - reg 2 (escritura): din[7:0] (dato a enviar, lanza transferencia)
- *  - reg 3 (escritura): ctrl {14'b0, cpha, cpol, dvsr[15:0]}
+ *  - reg 2 (escritura): din[31:0] (encola en la tx FIFO)
+ *  - reg 3 (escritura): ctrl {3'b0, nbits[4:0], 5'b0, rx_dis, cpha, cpol,
+ *                       dvsr[15:0]}; nbits = ancho - 1
+ *  - reg 4 (lectura):  {11'b0, rx_level[4:0], 7'b0, valid, rx_dout[7:0]};
+ *                       la lectura extrae la palabra de la rx FIFO
+ *  - reg 5 (lectura):  rx_dout[31:0]; la lectura extrae la palabra
  **********************************************************************/
 class SpiCore {
 public:
@@ -18,10 +42,31 @@ public:
     * mapa de registros
     */
    enum {
-      RD_DATA_REG = 0,   /**< lectura: ready(bit8) + dout(bits 7..0) */
+      RD_DATA_REG = 0,   /**< lectura: estado + cabeza de la rx FIFO */
       SS_REG      = 1,   /**< escritura: slave select */
-      WR_DATA_REG = 2,   /**< escritura: dato tx (lanza transferencia) */
-      CTRL_REG    = 3    /**< escritura: {cpha, cpol, dvsr[15:0]} */
+      WR_DATA_REG = 2,   /**< escritura: dato tx (encola en la tx FIFO) */
+      CTRL_REG    = 3,   /**< escritura: {nbits, rx_dis, cpha, cpol, dvsr} */
+      RX_POP_REG  = 4,   /**< lectura: byte + valid + nivel; extrae la palabra */
+      RX_WORD_REG = 5    /**< lectura: palabra de 32 bits; la extrae */
+   };
+
+   /**
+    * campos de los registros
+    */
+   enum {
+      RX_DATA_FIELD  = 0x000000ff,  /**< bits 7..0: byte recibido */
+      READY_FIELD    = 0x00000100,  /**< bit 8 reg 0: tx FIFO vacia e inactivo */
+      TX_FULL_FIELD  = 0x00000200,  /**< bit 9 reg 0: tx FIFO llena */
+      RX_EMPTY_FIELD = 0x00000400,  /**< bit 10 reg 0: rx FIFO vacia */
+      RX_LEVEL_FIELD = 0x001f0000,  /**< bits 20..16: bytes en la rx FIFO */
+      TX_LEVEL_FIELD = 0x1f000000,  /**< bits 28..24 reg 0: bytes en la tx FIFO */
+      RX_VALID_FIELD = 0x00000100,  /**< bit 8 reg 4: byte valido */
+      RX_DIS_FIELD   = 0x00040000,  /**< bit 18 ctrl: no guarda lo recibido */
+      NBITS_FIELD    = 0x1f000000   /**< bits 28..24 ctrl: ancho - 1 */
+   };
+
+   enum {
+      FIFO_DEPTH = 16   /**< palabras de cada FIFO hw */
    };
 
    /**
@@ -45,6 +90,13 @@ public:
     */
    void set_mode(int cpol, int cpha);
 
+   /**
+    * configura el ancho de palabra.
+    * @param bits bits por palabra (1..32)
+    * @note no cambiar con una transferencia en curso
+    */
+   void set_width(int bits);
+
    /**
     * activa (pone a '0') el slave select n.
     * @param n indice del slave (0 o 1)
@@ -66,15 +118,63 @@ public:
    uint8_t transfer(uint8_t data);
 
    /**
-    * comprueba si el controlador SPI esta listo.
+    * transfiere n bytes en rafaga (full duplex).
+    * bloquea hasta recibir el ultimo byte.
+    * @param tx bytes a enviar
+    * @param rx bytes recibidos (puede ser el mismo buffer que tx)
+    * @param n # bytes
+    */
+   void transfer(const uint8_t *tx, uint8_t *rx, size_t n);
+
+   /**
+    * envia n bytes en rafaga descartando lo recibido (rx_dis).
+    * bloquea hasta que sale el ultimo byte.
+    * @param tx bytes a enviar
+    * @param n # bytes
+    */
+   void write(const uint8_t *tx, size_t n);
+
+   /**
+    * recibe n bytes en rafaga enviando un byte de relleno fijo.
+    * bloquea hasta recibir el ultimo byte.
+    * @param rx bytes recibidos
+    * @param n # bytes
+    * @param fill byte enviado en cada transferencia
+    */
+   void read(uint8_t *rx, size_t n, uint8_t fill = 0xFF);
+
+   /**
+    * comprueba si el controlador SPI esta listo (tx FIFO vacia y sin
+    * transferencia en curso).
     * @return true si esta listo
     */
    bool ready();
 
+   /**
+    * lanza la transferencia de una palabra y retorna sin esperar.
+    * @param word palabra a enviar (bits ancho-1..0)
+    * @note cada start() necesita su finish(); como mucho FIFO_DEPTH
+    *       palabras pendientes
+    */
+   void start(uint32_t word);
+
+   /**
+    * comprueba si queda alguna palabra por desplazar.
+    * @return true si hay una transferencia en curso o pendiente
+    */
+   bool busy();
+
+   /**
+    * espera a que termine la palabra lanzada mas antigua.
+    * @return palabra recibida (bits ancho-1..0)
+    */
+   uint32_t finish();
+
 private:
    uint32_t base_addr;
    uint32_t ctrl_data;   // registro de control en cache
    uint32_t ss_n_data;   // registro ss_n en cache
+   void burst(const uint8_t *tx, uint8_t *rx, size_t n, uint8_t fill);
 };
 
 #endif  // _SPI_CORE_H_INCLUDED
@@ -0,0 +1,118 @@
+#include "spi_flash.h"
+
+/**********************************************************************
+ * SpiFlash
+ **********************************************************************/
+SpiFlash::SpiFlash(SpiCore *spi_p, int ss) {
+   this->spi_p = spi_p;
+   this->ss = ss;
+}
+
+SpiFlash::~SpiFlash() {
+}
+
+uint32_t SpiFlash::read_id() {
+   uint8_t op = CMD_READ_ID;
+   uint8_t id[3];
+
+   spi_p->assert_ss(ss);
+   spi_p->write(&op, 1);
+   spi_p->read(id, 3);
+   spi_p->deassert_ss(ss);
+   return ((uint32_t) id[0] << 16) | ((uint32_t) id[1] << 8) | id[2];
+}
+
+bool SpiFlash::known_id(uint32_t id) {
+   return id == JEDEC_N25Q128 || id == JEDEC_N25Q256 || id == JEDEC_W25Q128;
+}
+
+void SpiFlash::read_begin(uint32_t addr) {
+   spi_p->assert_ss(ss);
+   cmd_addr(CMD_FAST_READ, addr, 1);
+}
+
+void SpiFlash::read_next(uint8_t *buf, size_t n) {
+   spi_p->read(buf, n);
+}
+
+void SpiFlash::read_end() {
+   spi_p->deassert_ss(ss);
+}
+
+void SpiFlash::read(uint32_t addr, uint8_t *buf, size_t n) {
+   read_begin(addr);
+   read_next(buf, n);
+   read_end();
+}
+
+bool SpiFlash::program(uint32_t addr, const uint8_t *buf, size_t n) {
+   size_t chunk;
+
+   while (n > 0) {
+      // una pagina por comando: la flash da la vuelta dentro de la pagina
+      chunk = PAGE_SIZE - (addr & (PAGE_SIZE - 1));
+      if (chunk > n)
+         chunk = n;
+      cmd(CMD_WRITE_ENABLE);
+      spi_p->assert_ss(ss);
+      cmd_addr(CMD_PAGE_PROGRAM, addr, 0);
+      spi_p->write(buf, chunk);
+      spi_p->deassert_ss(ss);
+      if (!wait_ready(PROGRAM_TIMEOUT_US))
+         return false;
+      addr += chunk;
+      buf += chunk;
+      n -= chunk;
+   }
+   return true;
+}
+
+bool SpiFlash::erase_sector(uint32_t addr) {
+   cmd(CMD_WRITE_ENABLE);
+   spi_p->assert_ss(ss);
+   cmd_addr(CMD_SECTOR_ERASE, addr, 0);
+   spi_p->deassert_ss(ss);
+   return wait_ready(ERASE_TIMEOUT_US);
+}
+
+// ---- Helpers privados ----
+// comando de un byte con su propio ss
+void SpiFlash::cmd(uint8_t op) {
+   spi_p->assert_ss(ss);
+   spi_p->write(&op, 1);
+   spi_p->deassert_ss(ss);
+}
+
+// comando + direccion de 3 bytes + dummy bytes (ss ya activo)
+void SpiFlash::cmd_addr(uint8_t op, uint32_t addr, int dummy) {
+   uint8_t hdr[5];
+
+   hdr[0] = op;
+   hdr[1] = (uint8_t) (addr >> 16);
+   hdr[2] = (uint8_t) (addr >> 8);
+   hdr[3] = (uint8_t) addr;
+   hdr[4] = 0;
+   spi_p->write(hdr, 4 + dummy);
+}
+
+uint8_t SpiFlash::read_status() {
+   uint8_t op = CMD_READ_STATUS;
+   uint8_t st;
+
+   spi_p->assert_ss(ss);
+   spi_p->write(&op, 1);
+   spi_p->read(&st, 1);
+   spi_p->deassert_ss(ss);
+   return st;
+}
+
+// espera acotada: sin flash MISO flota y WIP puede leerse siempre a 1
+bool SpiFlash::wait_ready(uint32_t timeout_us) {
+   uint32_t start = now_tick32();
+
+   while (read_status() & STATUS_WIP_FIELD) {
+      if (now_tick32() - start > timeout_us * SYS_CLK_FREQ)
+         return false;
+   }
+   return true;
+}
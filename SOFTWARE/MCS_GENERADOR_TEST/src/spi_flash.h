@@ -0,0 +1,145 @@
+#ifndef _SPI_FLASH_H_INCLUDED
+#define _SPI_FLASH_H_INCLUDED
+#include "init.h"
+#include "spi_core.h"
+
+/**********************************************************************
+ * SpiFlash: memoria SPI NOR serie (serie 25, p.ej. N25Q/W25Q) en un
+ * slave select del slot SPI
+ *  - direcciones de 3 bytes (16 MB), lectura rapida 0x0B (1 byte dummy)
+ *  - lectura secuencial: read_begin() envia comando y direccion y cada
+ *    read_next() continua donde termino la anterior (una rafaga SPI)
+ *  - program() parte las escrituras en paginas de PAGE_SIZE bytes y
+ *    espera el fin de cada una; erase_sector() borra SECTOR_SIZE bytes
+ *  - las esperas (bit WIP) estan acotadas por los tiempos maximos del
+ *    fabricante: MISO no tiene pull-up, y sin flash (o con una que no
+ *    responde) se lee WIP a 1 para siempre; al vencer devuelven false
+ *  - read_id() + known_id() permiten comprobar que hay una flash
+ *    conocida antes de usarla
+ *  - el SpiCore debe estar en modo 0 (o 3) y 8 bits; la frecuencia la
+ *    fija la aplicacion
+ *  - en el host (test/) SimFlash la conecta a la NOR del bus simulado
+ *
+ * Ejemplo:
+ *    SpiFlash flash(&spi, 1);
+ *    if (SpiFlash::known_id(flash.read_id()))
+ *       flash.read(0x1000, buf, 64);
+ **********************************************************************/
+class SpiFlash {
+public:
+   /**
+    * comandos
+    */
+   enum {
+      CMD_WRITE_ENABLE = 0x06,
+      CMD_READ_STATUS  = 0x05,
+      CMD_PAGE_PROGRAM = 0x02,
+      CMD_SECTOR_ERASE = 0x20,   /**< subsector de 4 KB */
+      CMD_FAST_READ    = 0x0B,
+      CMD_READ_ID      = 0x9F
+   };
+
+   /**
+    * campos del registro de estado
+    */
+   enum {
+      STATUS_WIP_FIELD = 0x01   /**< bit 0: escritura/borrado en curso */
+   };
+
+   enum {
+      PAGE_SIZE   = 256,
+      SECTOR_SIZE = 4096
+   };
+
+   /**
+    * identificadores JEDEC {fabricante, tipo, capacidad} soportados
+    */
+   enum {
+      JEDEC_N25Q128 = 0x20BA18,   /**< Micron N25Q128A (3 V) */
+      JEDEC_N25Q256 = 0x20BA19,   /**< Micron N25Q256A (Pmod SF3) */
+      JEDEC_W25Q128 = 0xEF4018    /**< Winbond W25Q128 */
+   };
+
+   /**
+    * esperas maximas (peor caso de las hojas de datos, con margen)
+    */
+   static const uint32_t PROGRAM_TIMEOUT_US = 10000;     // pagina: 5 ms
+   static const uint32_t ERASE_TIMEOUT_US = 1000000;     // 4 KB: 0.8 s
+
+   /**
+    * constructor.
+    * @param spi_p puntero a la instancia SpiCore
+    * @param ss slave select de la flash
+    */
+   SpiFlash(SpiCore *spi_p, int ss);
+   ~SpiFlash();
+
+   /**
+    * lee el identificador JEDEC.
+    * @return {fabricante, tipo, capacidad} en los bits 23..0
+    */
+   uint32_t read_id();
+
+   /**
+    * comprueba un identificador JEDEC.
+    * @param id valor de read_id()
+    * @return true si es una de las flash soportadas (JEDEC_*)
+    * @note sin flash MISO flota: suele leerse 0xFFFFFF o 0x000000
+    */
+   static bool known_id(uint32_t id);
+
+   /**
+    * abre una lectura secuencial (ss activo hasta read_end()).
+    * @param addr direccion del primer byte
+    */
+   void read_begin(uint32_t addr);
+
+   /**
+    * lee los n bytes siguientes de la lectura secuencial.
+    * @param buf destino
+    * @param n # bytes
+    */
+   void read_next(uint8_t *buf, size_t n);
+
+   /**
+    * cierra la lectura secuencial.
+    */
+   void read_end();
+
+   /**
+    * lee n bytes a partir de addr (read_begin + read_next + read_end).
+    * @param addr direccion del primer byte
+    * @param buf destino
+    * @param n # bytes
+    */
+   void read(uint32_t addr, uint8_t *buf, size_t n);
+
+   /**
+    * programa n bytes a partir de addr (la zona debe estar borrada).
+    * bloquea hasta que la flash termina (como mucho PROGRAM_TIMEOUT_US
+    * por pagina).
+    * @param addr direccion del primer byte
+    * @param buf datos
+    * @param n # bytes
+    * @return false si la flash no termina a tiempo (se abandona)
+    */
+   bool program(uint32_t addr, const uint8_t *buf, size_t n);
+
+   /**
+    * borra el sector de SECTOR_SIZE bytes que contiene addr (0xFF).
+    * bloquea hasta que la flash termina (como mucho ERASE_TIMEOUT_US).
+    * @param addr cualquier direccion del sector
+    * @return false si la flash no termina a tiempo
+    */
+   bool erase_sector(uint32_t addr);
+
+private:
+   SpiCore *spi_p;
+   int ss;
+   void cmd(uint8_t op);
+   void cmd_addr(uint8_t op, uint32_t addr, int dummy);
+   uint8_t read_status();
+   bool wait_ready(uint32_t timeout_us);
+};
+
+#endif  // _SPI_FLASH_H_INCLUDED
@@ -31,21 +31,77 @@ void TimerCore::clear() {
 
 uint64_t TimerCore::read_tick() {
    uint64_t upper, lower;
+   // la lectura de LOWER captura UPPER en el hardware: el orden importa
    lower = (uint64_t) io_read(base_addr, COUNTER_LOWER_REG);
    upper = (uint64_t) io_read(base_addr, COUNTER_UPPER_REG);
    return ((upper << 32) | lower);
 }
 
+uint32_t TimerCore::read_tick32() {
+   return (io_read(base_addr, COUNTER_LOWER_REG));
+}
+
 uint64_t TimerCore::read_time() {
    // tiempo transcurrido en microsegundos (SYS_CLK_FREQ in MHz)
-   return (read_tick() / SYS_CLK_FREQ);
+   return (tick_div_apply(read_tick(), TICK_TO_US));
+}
+
+uint64_t TimerCore::read_time_ms() {
+   return (tick_div_apply(read_tick(), TICK_TO_MS));
+}
+
+void TimerCore::set_alarm(int ch, uint32_t ticks) {
+   set_alarm_at(ch, read_tick32() + ticks);
+}
+
+void TimerCore::set_alarm_at(int ch, uint32_t tick) {
+   uint32_t base = ch * ALARM_STRIDE;
+
+   io_write(base_addr, PERIOD0_REG + base, 0);
+   io_write(base_addr, CMP0_REG + base, tick);
+}
+
+uint32_t TimerCore::set_periodic(int ch, uint32_t period) {
+   uint32_t base = ch * ALARM_STRIDE;
+   uint32_t first;
+
+   first = read_tick32() + period;
+   io_write(base_addr, PERIOD0_REG + base, period);
+   io_write(base_addr, CMP0_REG + base, first);
+   return (first);
+}
+
+int TimerCore::poll_alarm(int ch) {
+   uint32_t stat;
+
+   // la lectura de STAT borra los flags en el hardware
+   stat = io_read(base_addr, STAT0_REG + ch * ALARM_STRIDE);
+   if (stat & OVR_FIELD)
+      return (ALARM_OVERRUN);
+   return ((stat & MATCH_FIELD) ? ALARM_MATCH : ALARM_NONE);
+}
+
+void TimerCore::cancel_alarm(int ch) {
+   io_write(base_addr, STAT0_REG + ch * ALARM_STRIDE, 0);
+   (void) io_read(base_addr, STAT0_REG + ch * ALARM_STRIDE);  // borra flags
 }
 
 void TimerCore::sleep(uint64_t us) {
-   uint64_t start_time, now;
-   start_time = read_time();
+   uint64_t start, ticks;
+   uint32_t start32, ticks32;
+
+   // se compara en ticks: sin conversion dentro del bucle
+   ticks = us * SYS_CLK_FREQ;
+   if (ticks < 0x80000000ULL) {
+      // intervalo corto: un acceso por iteracion, resta modulo 2^32
+      ticks32 = (uint32_t) ticks;
+      start32 = read_tick32();
+      while ((uint32_t) (read_tick32() - start32) < ticks32) {
+      }
+      return;
+   }
+   start = read_tick();
    // bucle de espera
-   do {
-      now = read_time();
-   } while ((now - start_time) < us);
+   while ((read_tick() - start) < ticks) {
+   }
 }
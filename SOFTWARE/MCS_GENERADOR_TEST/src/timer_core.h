@@ -4,13 +4,64 @@
 #include "io_rw.h"  /* para accesos de lectura y escritura a registros*/
 #include "io_map.h" /* para obtener system clock rate  */
 
+/* Division de ticks (48 bits) por una constante sin dividir:
+ *   tick = hi*2^32 + lo  ->  tick/d = hi*hi_q + (lo + hi*hi_r)/d
+ * con 2^32 = hi_q*d + hi_r. El segundo cociente (x < 2^32 + 2^16*hi_r)
+ * se hace con x >> pre (pre = factores 2 de d) y multiplicacion por el
+ * reciproco: (x * mul) >> shift, exacto para todo x del rango (se
+ * comprueba en compilacion). */
+struct TickDiv {
+   uint32_t hi_q;   /* 2^32 / d */
+   uint32_t hi_r;   /* 2^32 % d */
+   int pre;         /* # ceros bajos de d */
+   uint64_t mul;    /* ceil(2^shift / (d >> pre)) */
+   int shift;
+   bool ok;         /* encontrado mul/shift exacto y sin desborde */
+};
+
+static constexpr TickDiv tick_div(uint64_t d) {
+   TickDiv c = {};
+   uint64_t dd = d, xmax = 0, e = 0;
+
+   c.hi_q = (uint32_t) ((1ULL << 32) / d);
+   c.hi_r = (uint32_t) ((1ULL << 32) % d);
+   while ((dd & 1) == 0) {
+      dd >>= 1;
+      c.pre++;
+   }
+   xmax = (0xFFFFFFFFULL + 0xFFFFULL * c.hi_r) >> c.pre;
+   for (int s = 0; s < 64 && !c.ok; s++) {
+      c.mul = ((1ULL << s) + dd - 1) / dd;
+      e = c.mul * dd - (1ULL << s);
+      if (c.mul <= ~0ULL / xmax && e <= ((1ULL << s) - 1) / xmax) {
+         c.shift = s;
+         c.ok = true;
+      }
+   }
+   return c;
+}
+
+static inline uint64_t tick_div_apply(uint64_t tick, const TickDiv &c) {
+   uint32_t hi = (uint32_t) (tick >> 32);
+   uint64_t x = ((uint64_t) (uint32_t) tick + (uint64_t) hi * c.hi_r) >> c.pre;
+   return (uint64_t) hi * c.hi_q + ((x * c.mul) >> c.shift);
+}
+
+static constexpr TickDiv TICK_TO_US = tick_div(SYS_CLK_FREQ);
+static constexpr TickDiv TICK_TO_MS = tick_div(SYS_CLK_FREQ * 1000ULL);
+static_assert(TICK_TO_US.ok && TICK_TO_MS.ok, "sin reciproco exacto para SYS_CLK_FREQ");
+
 class TimerCore {
 
 /* mapa de registros */
 enum {
 COUNTER_LOWER_REG = 0, /* registro con los 32 bits bajos del contador*/
 COUNTER_UPPER_REG = 1, /* registro con los 16 bits altos del contador */
-CTRL_REG = 2 	   /* registro de control. Sólo relevantes bit 1 y bit 0 */
+CTRL_REG = 2, 	   /* registro de control. Sólo relevantes bit 1 y bit 0 */
+CMP0_REG = 4,      /* canal 0: tick de disparo (escribir arma el canal) */
+PERIOD0_REG = 5,   /* canal 0: recarga (0 = un solo disparo) */
+STAT0_REG = 6,     /* canal 0: R flags (la lectura los borra), W desarma */
+ALARM_STRIDE = 4   /* separacion entre canales */
 };
 
 /* máscaras para registro de control */
@@ -19,7 +70,24 @@ GO_FIELD =  0x00000001, /* < bit 0 enable bit */
 CLR_FIELD = 0x00000002  /* < bit 1 clear bit */
 };
 
+/* máscaras para STATn */
+enum {
+MATCH_FIELD = 0x00000001, /* < bit 0 disparo (sticky) */
+OVR_FIELD =   0x00000002, /* < bit 1 disparo con el anterior sin leer */
+ARMED_FIELD = 0x00000004  /* < bit 2 canal armado */
+};
+
 public:
+/* canales de comparacion (alarmas) */
+static const int NUM_ALARMS = 2;
+
+/* resultado de poll_alarm() */
+enum {
+ALARM_NONE = 0,    /* sin disparo */
+ALARM_MATCH = 1,   /* un disparo */
+ALARM_OVERRUN = 2  /* mas de un disparo desde el ultimo poll (periodico) */
+};
+
 TimerCore(uint32_t core_base_addr); // constructor
 ~TimerCore(); 		      // destructor; no usado
 
@@ -27,10 +95,20 @@ TimerCore(uint32_t core_base_addr); // constructor
 void pause(); // pausar al contador
 void go();    // habilitar al contador
 void clear(); // resetea el contador a 0
-uint64_t read_tick(); //obtiene el número de clocks transcurridos
+uint64_t read_tick(); //obtiene el número de clocks transcurridos (48 bits, coherente)
+uint32_t read_tick32(); //32 bits bajos de read_tick(); un acceso, para intervalos cortos (< 34 s)
 uint64_t read_time(); //obtiene el tiempo transcurrido (en microsegundos)
+uint64_t read_time_ms(); //obtiene el tiempo transcurrido (en milisegundos)
 void sleep(uint64_t us); //inactiva durante us microsegundos
 
+/* alarmas: el hardware compara los 32 bits bajos del contador; todos los
+ * tiempos en ticks (SYS_CLK_FREQ), < 2^31 (17 s) */
+void set_alarm(int ch, uint32_t ticks); //un disparo dentro de ticks
+void set_alarm_at(int ch, uint32_t tick); //un disparo cuando read_tick32() alcance tick
+uint32_t set_periodic(int ch, uint32_t period); //disparo cada period ticks desde ahora; devuelve el tick del primero
+int poll_alarm(int ch); //una lectura: ALARM_NONE/MATCH/OVERRUN; consume el disparo
+void cancel_alarm(int ch); //desarma el canal y descarta disparos pendientes
+
 private:
 uint32_t base_addr;  // dirección base
 uint32_t ctrl; 	// estado actual del registro de control
@@ -0,0 +1,100 @@
+#include "trace.h"
+#include "uart_core.h"
+
+static_assert((TRACE_SIZE & (TRACE_SIZE - 1)) == 0, "TRACE_SIZE debe ser potencia de 2");
+
+struct TraceRec {
+   uint32_t tick;     // 32 bits bajos del timer (ciclos de SYS_CLK_FREQ)
+   const char *msg;
+   int a1;
+   int a2;
+};
+
+static TraceRec trace_buf[TRACE_SIZE];
+static uint32_t trace_head = 0;    // registros escritos (no se enmascara)
+static uint32_t trace_base = 0;    // trace_head en el ultimo trace_clear()
+
+void trace_put(const char *msg, int a1, int a2) {
+   TraceRec *rec = &trace_buf[trace_head & (TRACE_SIZE - 1)];
+
+   rec->tick = now_tick32();
+   rec->msg = msg;
+   rec->a1 = a1;
+   rec->a2 = a2;
+   trace_head++;
+}
+
+void trace_clear() {
+   trace_base = trace_head;
+}
+
+int trace_count() {
+   uint32_t n = trace_head - trace_base;
+   return (n > TRACE_SIZE) ? TRACE_SIZE : (int) n;
+}
+
+uint32_t trace_lost() {
+   uint32_t n = trace_head - trace_base;
+   return (n > TRACE_SIZE) ? n - TRACE_SIZE : 0;
+}
+
+void trace_dump(UartCore *uart_p) {
+   const TraceRec *rec;
+   uint32_t first, prev, i;
+   int n;
+
+   n = trace_count();
+   first = trace_head - (uint32_t) n;
+   uart_p->disp("trace: ");
+   uart_p->disp(n);
+   uart_p->disp(" registros, ");
+   uart_p->disp((int) trace_lost());
+   uart_p->disp(" perdidos\n\r");
+   prev = (n > 0) ? trace_buf[first & (TRACE_SIZE - 1)].tick : 0;
+   for (i = first; i != trace_head; i++) {
+      rec = &trace_buf[i & (TRACE_SIZE - 1)];
+      // la resta modulo 2^32 da el delta aunque el tick de la vuelta
+      uart_p->disp((int) (rec->tick / SYS_CLK_FREQ), 10, 11);
+      uart_p->disp(" +");
+      uart_p->disp((int) ((rec->tick - prev) / SYS_CLK_FREQ), 10, 8);
+      uart_p->disp("  ");
+      uart_p->disp(rec->msg);
+      uart_p->disp("  0x");
+      uart_p->disp(rec->a1, 16);
+      uart_p->disp(" 0x");
+      uart_p->disp(rec->a2, 16);
+      uart_p->disp("\n\r");
+      prev = rec->tick;
+   }
+}
+
+static void put_u32(UartCore *uart_p, uint32_t v) {
+   uart_p->tx_byte((uint8_t) v);
+   uart_p->tx_byte((uint8_t) (v >> 8));
+   uart_p->tx_byte((uint8_t) (v >> 16));
+   uart_p->tx_byte((uint8_t) (v >> 24));
+}
+
+void trace_dump_bin(UartCore *uart_p) {
+   const TraceRec *rec;
+   uint32_t first, i;
+   int n, len, k;
+
+   n = trace_count();
+   first = trace_head - (uint32_t) n;
+   uart_p->disp("TRC1");
+   put_u32(uart_p, SYS_CLK_FREQ);
+   put_u32(uart_p, (uint32_t) n);
+   put_u32(uart_p, trace_lost());
+   for (i = first; i != trace_head; i++) {
+      rec = &trace_buf[i & (TRACE_SIZE - 1)];
+      put_u32(uart_p, rec->tick);
+      put_u32(uart_p, (uint32_t) rec->a1);
+      put_u32(uart_p, (uint32_t) rec->a2);
+      for (len = 0; len < 255 && rec->msg[len]; len++) {
+      }
+      uart_p->tx_byte((uint8_t) len);
+      for (k = 0; k < len; k++)
+         uart_p->tx_byte((uint8_t) rec->msg[k]);
+   }
+}
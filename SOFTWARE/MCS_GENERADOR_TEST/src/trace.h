@@ -0,0 +1,96 @@
+#ifndef _TRACE_H_INCLUDED
+#define _TRACE_H_INCLUDED
+#include "init.h"
+
+class UartCore;
+
+/**********************************************************************
+ * trace: registro binario de eventos con marca de tiempo
+ *  - ring de TRACE_SIZE registros {tick, msg, a1, a2} de 16 bytes;
+ *    al llenarse se sobrescriben los mas antiguos
+ *  - trace_put() solo copia 4 palabras (sin formatear): msg es un
+ *    puntero a un literal y el texto se genera en trace_dump()
+ *  - filtrado en compilacion por categoria: trace(cat, ...) con cat
+ *    fuera de TRACE_MASK no genera codigo
+ *  - TRACE_MASK se define en las opciones del compilador o en cada
+ *    fichero antes de incluir trace.h (por defecto TRACE_ALL)
+ *  - debug() (init.h, con _DEBUG) escribe en este ring (TRACE_DEBUG)
+ *
+ *  - trace_dump_bin() envia el ring sin formatear para decodificarlo en
+ *    el host (test/trace_decode.h); little-endian:
+ *       'T' 'R' 'C' '1' | SYS_CLK_FREQ(4) | n(4) | perdidos(4)
+ *       n x {tick(4) | a1(4) | a2(4) | long(1) | msg(long)}
+ *
+ * Ejemplo:
+ *    #define TRACE_MASK (TRACE_LINK | TRACE_APP)
+ *    #include "trace.h"
+ *    trace(TRACE_LINK, "frame", op, status);
+ *    ...
+ *    trace_dump(&uart);   // tick (us), delta (us), msg, a1, a2
+ **********************************************************************/
+
+// categorias
+#define TRACE_DDS   0x01
+#define TRACE_AWG   0x02
+#define TRACE_UART  0x04
+#define TRACE_LINK  0x08
+#define TRACE_APP   0x10
+#define TRACE_DEBUG 0x80
+#define TRACE_ALL   0xFF
+
+#ifndef TRACE_MASK
+#define TRACE_MASK TRACE_ALL
+#endif
+
+#ifndef TRACE_SIZE
+#define TRACE_SIZE 128   // registros (potencia de 2)
+#endif
+
+#define trace(cat, msg, a1, a2) \
+do { \
+   if (((cat) & (TRACE_MASK)) != 0) \
+      trace_put((msg), (int) (a1), (int) (a2)); \
+} while (0)
+
+/**
+ * anade un registro al ring (usar la macro trace()).
+ * @param msg literal que identifica el evento (no se copia)
+ * @param a1 primer argumento
+ * @param a2 segundo argumento
+ */
+void trace_put(const char *msg, int a1, int a2);
+
+/**
+ * vacia el ring y reinicia el contador de registros perdidos.
+ */
+void trace_clear();
+
+/**
+ * registros almacenados en el ring.
+ * @return # registros (0..TRACE_SIZE)
+ */
+int trace_count();
+
+/**
+ * registros sobrescritos desde el ultimo trace_clear().
+ * @return # registros perdidos
+ */
+uint32_t trace_lost();
+
+/**
+ * imprime el ring como linea de tiempo, del mas antiguo al mas nuevo:
+ * tick en us, delta con el anterior en us, msg, a1 y a2 (hex).
+ * @param uart_p uart de salida
+ * @note formatea todo aqui; el ring no se vacia
+ */
+void trace_dump(UartCore *uart_p);
+
+/**
+ * envia el ring en binario, del mas antiguo al mas nuevo (formato en la
+ * cabecera de este fichero); solo copia bytes, sin formatear numeros.
+ * @param uart_p uart de salida
+ * @note msg se recorta a 255 caracteres; el ring no se vacia
+ */
+void trace_dump_bin(UartCore *uart_p);
+
+#endif // _TRACE_H_INCLUDED
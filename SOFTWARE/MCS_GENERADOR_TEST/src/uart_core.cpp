@@ -1,8 +1,36 @@
 
 #include "uart_core.h"
 
+/**********************************************************************
+ * Formateo sin divisiones (el MCS no tiene divisor hardware)
+ *  - n/100 y n/10 exactos para todo uint32_t con multiplicacion por el
+ *    reciproco (constantes de gcc para la division por constante)
+ *  - dos digitos decimales por iteracion con la tabla de pares
+ **********************************************************************/
+static const uint32_t POW10[10] = {
+   1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+static const char DIGIT_PAIRS[201] =
+   "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+   "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+   "8081828384858687888990919293949596979899";
+
+static inline uint32_t div100(uint32_t n) {
+   return (uint32_t) (((uint64_t) n * 0x51EB851Fu) >> 37);
+}
+
+static inline uint32_t div10(uint32_t n) {
+   return (uint32_t) (((uint64_t) n * 0xCCCCCCCDu) >> 35);
+}
+
 UartCore::UartCore(uint32_t core_base_addr) {
    base_addr = core_base_addr;
+   tx_head = 0;
+   tx_tail = 0;
+   tx_policy = TX_BLOCK;
+   tx_hold = false;
+   clear_tx_stats();
    set_baud_rate(9600);      // baud rate por defecto
 }
 
@@ -36,21 +64,103 @@ int UartCore::tx_fifo_full() {
 }
 
 void UartCore::tx_byte(uint8_t byte) {
-   while (tx_fifo_full()) {
-   };  // busy waiting
-   io_write(base_addr, WR_DATA_REG, (uint32_t )byte);
+   int used;
+
+   // ring vacio y hueco en la FIFO hw: directo, sin copia
+   if (tx_head == tx_tail && !tx_hold && !tx_fifo_full()) {
+      io_write(base_addr, WR_DATA_REG, (uint32_t )byte);
+      return;
+   }
+   used = (tx_head - tx_tail) & (TX_BUF_SIZE - 1);
+   if (used == TX_BUF_SIZE - 1) {
+      if (tx_policy == TX_DROP || tx_hold) {
+         tx_dropped++;
+         return;
+      }
+      while (poll() == 0) {
+      };  // busy waiting hasta liberar hueco
+      used = (tx_head - tx_tail) & (TX_BUF_SIZE - 1);
+   }
+   tx_buf[tx_head] = byte;
+   tx_head = (tx_head + 1) & (TX_BUF_SIZE - 1);
+   if (used + 1 > tx_hwm)
+      tx_hwm = used + 1;
+}
+
+int UartCore::poll() {
+   int n = 0;
+
+   if (tx_hold)
+      return (0);
+   while (tx_tail != tx_head && !tx_fifo_full()) {
+      io_write(base_addr, WR_DATA_REG, (uint32_t) tx_buf[tx_tail]);
+      tx_tail = (tx_tail + 1) & (TX_BUF_SIZE - 1);
+      n++;
+   }
+   return (n);
+}
+
+void UartCore::flush() {
+   while (tx_tail != tx_head && !tx_hold)
+      poll();
+}
+
+void UartCore::set_tx_hold(bool on) {
+   tx_hold = on;
+}
+
+void UartCore::tx_discard() {
+   tx_tail = tx_head;
+}
+
+void UartCore::set_tx_policy(int policy) {
+   tx_policy = (policy == TX_DROP) ? TX_DROP : TX_BLOCK;
+}
+
+int UartCore::tx_pending() {
+   return ((tx_head - tx_tail) & (TX_BUF_SIZE - 1));
+}
+
+int UartCore::get_tx_high_water() {
+   return (tx_hwm);
+}
+
+uint32_t UartCore::get_tx_dropped() {
+   return (tx_dropped);
+}
+
+void UartCore::clear_tx_stats() {
+   tx_hwm = 0;
+   tx_dropped = 0;
 }
 
 int UartCore::rx_byte() {
-   uint32_t data;
+   uint32_t rd_word;
 
-   if (rx_fifo_empty())
+   rd_word = io_read(base_addr, RX_POP_REG);  // la lectura elimina el dato de la rx FIFO
+   if (!(rd_word & RX_VALID_FIELD))
       return (-1);
-   else {
-      data = io_read(base_addr, RD_DATA_REG) & RX_DATA_FIELD;
-      io_write(base_addr, RM_RD_DATA_REG, 0); //escribe para eliminar datos de la rx FIFO
-      return ((int) data);
+   return ((int) (rd_word & RX_DATA_FIELD));
+}
+
+int UartCore::rx_read(uint8_t *buf, size_t max) {
+   uint32_t rd_word;
+   size_t n = 0;
+
+   while (n < max) {
+      rd_word = io_read(base_addr, RX_POP_REG);
+      if (!(rd_word & RX_VALID_FIELD))
+         break;
+      buf[n++] = (uint8_t) (rd_word & RX_DATA_FIELD);
    }
+   return ((int) n);
+}
+
+int UartCore::rx_level() {
+   uint32_t rd_word;
+
+   rd_word = io_read(base_addr, RD_DATA_REG);
+   return ((int) ((rd_word & RX_LEVEL_FIELD) >> 16));
 }
 
 void UartCore::disp(const char *str) {
@@ -62,52 +172,10 @@ void UartCore::disp(char ch) {
 }
 
 void UartCore::disp(int n, int base, int len) {
-   char buf[33];         // 32 bit #
-   char *str, ch, sign;
-   int rem, i;
-   unsigned int un;
+   char buf[FMT_BUF_SIZE];
 
-   /* error check */
-   if (base != 2 && base != 8 && base != 16)
-      base = 10;
-   if (len > 32)
-      len = 32;
-   /* manejar neg decimal # */
-   if (base == 10 && n < 0) {
-      un = (unsigned) -n;
-      sign = '-';
-   } else {
-      un = (unsigned) n; // interpretado como unsigned para hex/bin conversion
-      sign = ' ';
-   }
-   /* convierte # a string */
-   str = &buf[33];
-   *str = '\0';
-   i = 0;
-   do {
-      str--;
-      rem = un % base;
-      un = un / base;
-      if (rem < 10)
-         ch = (char) rem + '0';
-      else
-         ch = (char) rem - 10 + 'a';
-      *str = ch;
-      i++;
-   } while (un);
-   /* pega signo - para negativo decimal # */
-   if (sign == '-') {
-      str--;
-      *str = sign;
-      i++;
-   }
-   /* pad with blank */
-   while (i < len) {
-      str--;
-      *str = ' ';
-      i++;
-   };
-   disp_str(str);
+   format_int(buf, n, base, len);
+   disp_str(buf);
 }
 
 void UartCore::disp(int n) {
@@ -119,32 +187,142 @@ void UartCore::disp(int n, int base) {
 }
 
 void UartCore::disp(double f, int digit) {
-   double fa, frac; // absolute value of f
-   int n, i, i_part;
+   char buf[FMT_BUF_SIZE];
+   char *p;
+   double fa; // absolute value of f
+   uint32_t i_part, f_part, q;
+   int k;
 
+   if (digit < 0)
+      digit = 0;
+   if (digit > 9)
+      digit = 9;
+   p = buf;
    fa = f;
    if (f < 0.0) {
       fa = -f;
-      disp_str("-");
+      *p++ = '-';
    }
-   // display parte entera
-   i_part = (int) fa; // integer part of f
-   disp(i_part);
-   disp_str(".");
-   // display parte fraccional
-   frac = fa - (double) i_part;
-   for (n = 0; n < digit; n++) {
-      frac = frac * 10.0;
-      i = (int) frac;
-      disp(i);
-      frac = frac - i;
+   // una sola conversion por parte (soft-float); el resto en enteros
+   i_part = (uint32_t) fa;
+   f_part = (uint32_t) ((fa - (double) i_part) * (double) POW10[digit]);
+   p += format_int(p, (int) i_part, 10, 0);
+   *p++ = '.';
+   for (k = digit - 1; k >= 0; k--) {
+      q = div10(f_part);
+      p[k] = (char) (f_part - q * 10) + '0';
+      f_part = q;
    }
+   p[digit] = '\0';
+   disp_str(buf);
 }
 
 void UartCore::disp(double f) {
    disp(f, 3);
 }
 
+void UartCore::disp_fixed(int n, int frac_digits) {
+   char buf[FMT_BUF_SIZE];
+
+   format_fixed(buf, n, frac_digits);
+   disp_str(buf);
+}
+
+int UartCore::format_int(char *buf, int n, int base, int len) {
+   char *p, *end;
+   int shift, nd, pad, i;
+   uint32_t un, t, r, mask;
+   bool neg;
+
+   /* error check */
+   if (base != 2 && base != 8 && base != 16)
+      base = 10;
+   if (len > 32)
+      len = 32;
+   /* manejar neg decimal # */
+   neg = (base == 10 && n < 0);
+   un = neg ? 0u - (uint32_t) n : (uint32_t) n;
+   /* # digitos, sin dividir */
+   if (base == 10) {
+      nd = 1;
+      while (nd < 10 && un >= POW10[nd])
+         nd++;
+      shift = 0;
+   } else {
+      shift = (base == 2) ? 1 : (base == 8) ? 3 : 4;
+      nd = 1;
+      for (t = un >> shift; t; t >>= shift)
+         nd++;
+   }
+   /* relleno con blancos, signo y digitos (de derecha a izquierda) */
+   pad = len - nd - (neg ? 1 : 0);
+   p = buf;
+   for (i = 0; i < pad; i++)
+      *p++ = ' ';
+   if (neg)
+      *p++ = '-';
+   end = p + nd;
+   *end = '\0';
+   if (base == 10) {
+      while (un >= 100) {
+         t = div100(un);
+         r = un - t * 100;
+         end -= 2;
+         end[0] = DIGIT_PAIRS[2 * r];
+         end[1] = DIGIT_PAIRS[2 * r + 1];
+         un = t;
+      }
+      if (un >= 10) {
+         end -= 2;
+         end[0] = DIGIT_PAIRS[2 * un];
+         end[1] = DIGIT_PAIRS[2 * un + 1];
+      } else
+         *--end = (char) un + '0';
+   } else {
+      mask = (uint32_t) base - 1;
+      do {
+         r = un & mask;
+         *--end = (r < 10) ? (char) r + '0' : (char) r - 10 + 'a';
+         un >>= shift;
+      } while (un);
+   }
+   return (int) (p + nd - buf);
+}
+
+int UartCore::format_fixed(char *buf, int n, int frac_digits) {
+   char *p;
+   int nd, k, total;
+   uint32_t un, q;
+
+   if (frac_digits < 0)
+      frac_digits = 0;
+   if (frac_digits > 9)
+      frac_digits = 9;
+   p = buf;
+   un = (uint32_t) n;
+   if (n < 0) {
+      un = 0u - un;
+      *p++ = '-';
+   }
+   /* al menos un digito entero ("0.005") */
+   nd = 1;
+   while (nd < 10 && un >= POW10[nd])
+      nd++;
+   if (nd < frac_digits + 1)
+      nd = frac_digits + 1;
+   /* digitos de derecha a izquierda, con el punto tras la parte entera */
+   total = nd + (frac_digits ? 1 : 0);
+   p[total] = '\0';
+   if (frac_digits)
+      p[nd - frac_digits] = '.';
+   for (k = 0; k < nd; k++) {
+      q = div10(un);
+      p[(k < frac_digits) ? total - 1 - k : nd - 1 - k] = (char) (un - q * 10) + '0';
+      un = q;
+   }
+   return (int) (p + total - buf);
+}
+
 void UartCore::disp_str(const char *str) {
    while ((uint8_t) *str) {
       tx_byte(*str);
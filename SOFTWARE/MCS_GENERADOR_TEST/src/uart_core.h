@@ -4,6 +4,7 @@
 
 #include "io_rw.h"
 #include "io_map.h"  // to use SYS_CLK_FREQ
+#include <stddef.h>  // size_t
 /**
  * uart core driver
  * - transmite/recibe datos via MMIO uart core.
@@ -19,7 +20,8 @@ class UartCore {
       RD_DATA_REG = 0,   /**< rx data/status register */
       DVSR_REG = 1,      /**< baud rate divisor register */
       WR_DATA_REG = 2,   /**< wr data register */
-      RM_RD_DATA_REG = 3 /**< remove read data offset */
+      RM_RD_DATA_REG = 3, /**< remove read data offset */
+      RX_POP_REG = 4      /**< lectura: dato + valid + nivel; extrae el byte */
    };
   /**
    * mask fields
@@ -28,9 +30,33 @@ class UartCore {
    enum {
       TX_FULL_FIELD = 0x00000200, /**< bit 9 of rd_data_reg; full bit  */
       RX_EMPT_FIELD = 0x00000100, /**< bit 10 of rd_data_reg; empty bit */
-      RX_DATA_FIELD = 0x000000ff  /**< bits 7..0 rd_data_reg; read data */
+      RX_DATA_FIELD = 0x000000ff, /**< bits 7..0 rd_data_reg; read data */
+      RX_VALID_FIELD = 0x00000100, /**< bit 8 de rx_pop_reg; byte valido */
+      RX_LEVEL_FIELD = 0x001f0000  /**< bits 20..16; bytes en la rx FIFO */
    };
 public:
+   /**
+    * buffer de transmision software
+    *
+    */
+   enum {
+      TX_BUF_SIZE = 256  /**< bytes del ring TX (potencia de 2) */
+   };
+   /**
+    * politica de desborde del ring TX
+    *
+    */
+   enum {
+      TX_DROP = 0,  /**< descarta el byte nuevo si el ring esta lleno */
+      TX_BLOCK = 1  /**< espera a que la FIFO hw libere hueco */
+   };
+   /**
+    * formateo de numeros
+    *
+    */
+   enum {
+      FMT_BUF_SIZE = 36  /**< buffer minimo para format_int()/format_fixed() */
+   };
    /* methods */
    /**
     * constructor.
@@ -69,20 +95,112 @@ public:
     *
     * @param byte data byte a ser transmitido
     *
-    * @note la function espera si tx fifo está full;
-    *       para evitar "bloqueo" de ejecution, usar tx_fifo_full() para check status
+    * @note el byte se encola en el ring TX y la funcion retorna;
+    *       solo espera si el ring esta lleno y la politica es TX_BLOCK
     */
    void tx_byte(uint8_t byte);
 
+   /**
+    * vuelca el ring TX a la FIFO hw hasta llenarla o vaciar el ring
+    *
+    * @return # bytes movidos a la FIFO hw
+    *
+    * @note no espera; llamar periodicamente desde el bucle principal
+    */
+   int poll();
+
+   /**
+    * espera a que el ring TX quede vacio (retorna sin esperar con la
+    * transmision retenida)
+    *
+    */
+   void flush();
+
+   /**
+    * selecciona la politica de desborde del ring TX
+    *
+    * @param policy TX_DROP o TX_BLOCK (por defecto TX_BLOCK)
+    *
+    */
+   void set_tx_policy(int policy);
+
+   /**
+    * retiene (o libera) la transmision: con hold los bytes solo se
+    * encolan en el ring (ni escritura directa ni poll()) y, con el ring
+    * lleno, se descartan sea cual sea la politica
+    *
+    * @param on true para retener
+    *
+    * @note para medir disp() sin que su salida llegue a la uart (ver
+    *       tx_discard())
+    */
+   void set_tx_hold(bool on);
+
+   /**
+    * descarta los bytes pendientes en el ring TX (no los de la FIFO hw)
+    *
+    */
+   void tx_discard();
+
+   /**
+    * bytes pendientes en el ring TX
+    *
+    * @return # bytes encolados aun no pasados a la FIFO hw
+    *
+    */
+   int tx_pending();
+
+   /**
+    * maxima ocupacion del ring TX desde el ultimo clear_tx_stats()
+    *
+    * @return # bytes
+    *
+    */
+   int get_tx_high_water();
+
+   /**
+    * bytes descartados por desborde (politica TX_DROP)
+    *
+    * @return # bytes perdidos desde el ultimo clear_tx_stats()
+    *
+    */
+   uint32_t get_tx_dropped();
+
+   /**
+    * reinicia high-water mark y contador de descartes
+    *
+    */
+   void clear_tx_stats();
+
    /**
     * recibir un byte
     *
     * @return -1 if rx fifo empty; byte data other wise
     *
     * @note la función no "busy wait"
+    * @note un unico acceso al bus (lectura de RX_POP_REG)
     */
    int rx_byte();
 
+   /**
+    * recibe todos los bytes disponibles en la rx FIFO
+    *
+    * @param buf buffer destino
+    * @param max # maximo de bytes a copiar
+    * @return # bytes copiados (0 si la FIFO esta vacia)
+    *
+    * @note un acceso al bus por byte; no espera
+    */
+   int rx_read(uint8_t *buf, size_t max);
+
+   /**
+    * ocupacion de la rx FIFO (no extrae datos)
+    *
+    * @return # bytes pendientes de leer
+    *
+    */
+   int rx_level();
+
    /**
     * display (print) a char on a serial terminal console
     *
@@ -157,9 +275,53 @@ public:
     */
    void disp(double f);
 
+   /**
+    * display (print) un numero en coma fija decimal
+    *
+    * @param n valor escalado por 10^frac_digits (p.ej. mV con frac_digits=3)
+    * @param frac_digits # digitos de la parte fraccional (0..9)
+    * @note sin doubles ni divisiones
+    *
+    */
+   void disp_fixed(int n, int frac_digits);
+
+   /**
+    * formatea un entero en un buffer del llamante (una pasada)
+    *
+    * @param buf buffer de al menos FMT_BUF_SIZE bytes
+    * @param n entero a formatear
+    * @param base 2/8/10/16 (cualquier otro valor: 10)
+    * @param len # minimo de caracteres (relleno con blancos a la izquierda)
+    * @return # caracteres escritos (sin el '\0' final)
+    * @note base 10 con tabla de pares de digitos y division por 100
+    *       mediante multiplicacion por el reciproco; bases 2/8/16 con
+    *       desplazamientos. Sin divisiones
+    *
+    */
+   static int format_int(char *buf, int n, int base, int len);
+
+   /**
+    * formatea un numero en coma fija decimal en un buffer del llamante
+    *
+    * @param buf buffer de al menos FMT_BUF_SIZE bytes
+    * @param n valor escalado por 10^frac_digits
+    * @param frac_digits # digitos de la parte fraccional (0..9)
+    * @return # caracteres escritos (sin el '\0' final)
+    * @note frac_digits=0 no escribe el punto decimal
+    *
+    */
+   static int format_fixed(char *buf, int n, int frac_digits);
+
 private:
    uint32_t base_addr;
    int baud_rate;
+   uint8_t tx_buf[TX_BUF_SIZE];
+   volatile uint16_t tx_head;   // siguiente hueco libre
+   volatile uint16_t tx_tail;   // siguiente byte a enviar
+   int tx_policy;
+   bool tx_hold;                // transmision retenida (set_tx_hold)
+   int tx_hwm;
+   uint32_t tx_dropped;
    void disp_str(const char *str);
 };
 
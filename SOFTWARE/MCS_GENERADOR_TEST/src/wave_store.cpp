@@ -0,0 +1,196 @@
+#include "wave_store.h"
+#include "trace.h"
+
+static_assert(DdsAwgCore::DAC_WIDTH == 14, "formato empaquetado de 14 bits");
+static_assert(DdsAwgCore::TABLE_SIZE % 4 == 0, "TABLE_SIZE multiplo de 4");
+static_assert(WaveStore::PACKED_SIZE % WaveStore::BOUNCE_SIZE == 0,
+              "PACKED_SIZE multiplo de BOUNCE_SIZE");
+static_assert(WaveStore::BOUNCE_SIZE % 7 == 0, "BOUNCE_SIZE multiplo de 7");
+
+static uint32_t get_le32(const uint8_t *p) {
+   return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16)
+        | ((uint32_t) p[3] << 24);
+}
+
+static void put_le32(uint8_t *p, uint32_t v) {
+   p[0] = (uint8_t) v;
+   p[1] = (uint8_t) (v >> 8);
+   p[2] = (uint8_t) (v >> 16);
+   p[3] = (uint8_t) (v >> 24);
+}
+
+WaveStore::WaveStore(SpiFlash *flash_p, uint32_t size) {
+   this->flash_p = flash_p;
+   this->size = size;
+   n = -1;
+   data_end = DATA_START;
+}
+
+WaveStore::~WaveStore() {
+}
+
+bool WaveStore::mount() {
+   uint8_t hdr[16];
+   uint8_t raw[ENTRY_SIZE];
+   uint32_t addr;
+
+   n = -1;
+   flash_p->read(0, hdr, 16);
+   if (get_le32(&hdr[0]) != MAGIC || get_le32(&hdr[4]) != VERSION
+       || get_le32(&hdr[8]) != DdsAwgCore::TABLE_SIZE
+       || get_le32(&hdr[12]) != DdsAwgCore::DAC_WIDTH)
+      return false;
+   // la primera entrada libre cierra el directorio
+   n = 0;
+   data_end = DATA_START;
+   while (n < MAX_WAVES) {
+      flash_p->read(DIR_START + n * ENTRY_SIZE, raw, ENTRY_SIZE);
+      addr = get_le32(&raw[NAME_LEN]);
+      if (addr == 0xFFFFFFFF)
+         break;
+      data_end = addr + PACKED_SIZE;
+      n++;
+   }
+   return true;
+}
+
+bool WaveStore::format() {
+   uint8_t hdr[16];
+
+   n = -1;
+   if (!flash_p->erase_sector(0))
+      return false;
+   put_le32(&hdr[0], MAGIC);
+   put_le32(&hdr[4], VERSION);
+   put_le32(&hdr[8], DdsAwgCore::TABLE_SIZE);
+   put_le32(&hdr[12], DdsAwgCore::DAC_WIDTH);
+   if (!flash_p->program(0, hdr, 16))
+      return false;
+   n = 0;
+   data_end = DATA_START;
+   return true;
+}
+
+int WaveStore::count() {
+   return (n < 0) ? 0 : n;
+}
+
+bool WaveStore::get_entry(int idx, WaveEntry *e) {
+   uint8_t raw[ENTRY_SIZE];
+
+   if (idx < 0 || idx >= n)
+      return false;
+   flash_p->read(DIR_START + idx * ENTRY_SIZE, raw, ENTRY_SIZE);
+   for (int i = 0; i < NAME_LEN; i++)
+      e->name[i] = (char) raw[i];
+   e->name[NAME_LEN - 1] = 0;
+   e->addr = get_le32(&raw[NAME_LEN]);
+   e->crc = get_le32(&raw[NAME_LEN + 4]);
+   return true;
+}
+
+int WaveStore::find(const char *name) {
+   WaveEntry e;
+   int i, j;
+
+   for (i = 0; i < n; i++) {
+      get_entry(i, &e);
+      for (j = 0; j < NAME_LEN && e.name[j] == name[j] && name[j] != 0; j++) {}
+      if (j < NAME_LEN && e.name[j] == name[j])
+         return i;
+   }
+   return -1;
+}
+
+int WaveStore::add(const char *name, const uint16_t *table) {
+   uint8_t buf[BOUNCE_SIZE];
+   uint8_t raw[ENTRY_SIZE];
+   uint32_t addr, sec;
+   int i, j;
+
+   if (n < 0 || n >= MAX_WAVES || data_end + PACKED_SIZE > size)
+      return -1;
+   addr = data_end;
+   // borrar los sectores que aun no se han usado
+   sec = (addr + SpiFlash::SECTOR_SIZE - 1) & ~(uint32_t) (SpiFlash::SECTOR_SIZE - 1);
+   for (; sec < addr + PACKED_SIZE; sec += SpiFlash::SECTOR_SIZE) {
+      if (!flash_p->erase_sector(sec)) {
+         n = -1;   // zona de datos en estado incierto: hay que montar de nuevo
+         return -1;
+      }
+   }
+   // datos empaquetados por bloques
+   for (i = 0; i < PACKED_SIZE; i += BOUNCE_SIZE) {
+      for (j = 0; j < BOUNCE_SIZE; j += 7)
+         pack4(&table[(i + j) / 7 * 4], &buf[j]);
+      if (!flash_p->program(addr + i, buf, BOUNCE_SIZE)) {
+         n = -1;
+         return -1;
+      }
+   }
+   // la entrada se escribe al final: una tabla a medias no es visible
+   for (i = 0; i < NAME_LEN - 1 && name[i] != 0; i++)
+      raw[i] = (uint8_t) name[i];
+   for (; i < NAME_LEN; i++)
+      raw[i] = 0;
+   put_le32(&raw[NAME_LEN], addr);
+   put_le32(&raw[NAME_LEN + 4], DdsAwgCore::awg_crc32(table, DdsAwgCore::TABLE_SIZE));
+   if (!flash_p->program(DIR_START + n * ENTRY_SIZE, raw, ENTRY_SIZE)) {
+      n = -1;
+      return -1;
+   }
+   data_end = addr + PACKED_SIZE;
+   return n++;
+}
+
+bool WaveStore::load(int idx, DdsAwgCore *dds_p, bool play) {
+   uint8_t buf[BOUNCE_SIZE];
+   uint16_t s[4];
+   WaveEntry e;
+   bool ok;
+   int i, j;
+
+   if (!get_entry(idx, &e))
+      return false;
+   dds_p->awg_stream_begin();
+   flash_p->read_begin(e.addr);
+   for (i = 0; i < PACKED_SIZE; i += BOUNCE_SIZE) {
+      flash_p->read_next(buf, BOUNCE_SIZE);
+      for (j = 0; j < BOUNCE_SIZE; j += 7) {
+         unpack4(&buf[j], s);
+         dds_p->awg_stream_pair(s[0], s[1]);
+         dds_p->awg_stream_pair(s[2], s[3]);
+      }
+   }
+   flash_p->read_end();
+   ok = dds_p->awg_stream_end(false) && dds_p->awg_stream_crc() == e.crc;
+   if (ok && play)
+      ok = dds_p->select_bank(dds_p->get_write_bank());
+   trace(TRACE_AWG, "wave load", idx, ok);
+   return ok;
+}
+
+// s0 | s1 << 14 | s2 << 28 | s3 << 42, 56 bits en little-endian
+void WaveStore::pack4(const uint16_t *s, uint8_t *out) {
+   uint64_t w;
+
+   w = (uint64_t) (s[0] & DdsAwgCore::DAC_MAX)
+     | ((uint64_t) (s[1] & DdsAwgCore::DAC_MAX) << 14)
+     | ((uint64_t) (s[2] & DdsAwgCore::DAC_MAX) << 28)
+     | ((uint64_t) (s[3] & DdsAwgCore::DAC_MAX) << 42);
+   for (int i = 0; i < 7; i++)
+      out[i] = (uint8_t) (w >> (8 * i));
+}
+
+// dos mitades de 32 bits: el MCS no tiene desplazamientos de 64 bits
+void WaveStore::unpack4(const uint8_t *in, uint16_t *s) {
+   uint32_t lo, hi;
+
+   lo = (uint32_t) in[0] | ((uint32_t) in[1] << 8) | ((uint32_t) in[2] << 16)
+      | ((uint32_t) in[3] << 24);
+   hi = (uint32_t) in[4] | ((uint32_t) in[5] << 8) | ((uint32_t) in[6] << 16);
+   s[0] = (uint16_t) (lo & 0x3FFF);
+   s[1] = (uint16_t) ((lo >> 14) & 0x3FFF);
+   s[2] = (uint16_t) (((lo >> 28) | (hi << 4)) & 0x3FFF);
+   s[3] = (uint16_t) ((hi >> 10) & 0x3FFF);
+}
@@ -0,0 +1,145 @@
+#ifndef _WAVE_STORE_H_INCLUDED
+#define _WAVE_STORE_H_INCLUDED
+#include "init.h"
+#include "spi_flash.h"
+#include "dds_awg_core.h"
+
+/**********************************************************************
+ * WaveStore: biblioteca de formas de onda AWG en flash SPI
+ *  - directorio indexado en el sector 0 (cabecera + MAX_WAVES entradas
+ *    de 32 bytes {nombre, direccion, CRC32}); datos desde DATA_START
+ *  - cada tabla (TABLE_SIZE muestras de 14 bits) se guarda empaquetada:
+ *    4 muestras en 7 bytes (little-endian), PACKED_SIZE bytes por tabla
+ *  - load() lee la tabla con una unica lectura rapida secuencial y la
+ *    desempaqueta por bloques de BOUNCE_SIZE bytes directamente en la
+ *    RAM AWG (awg_stream_pair), sin la tabla completa en memoria
+ *  - se comprueba el CRC del hardware (lo escrito) y el del directorio
+ *    (lo leido de la flash) antes de conmutar de banco
+ *  - solo anadir: las entradas nuevas van tras la ultima y los sectores
+ *    de datos se borran al llegar a ellos; format() vacia el directorio
+ *  - format()/add() son una programacion explicita de la biblioteca
+ *    (herramienta de carga o prueba), nunca un efecto del arranque: si
+ *    mount() falla el arranque sigue sin biblioteca. Los errores de la
+ *    flash (espera vencida) se devuelven, no bloquean
+ *  - en el host se prueba sobre SimFlash (test/sim_flash.h)
+ *
+ * Formato del directorio (little-endian):
+ *  - cabecera: {magic "AWGS", version, TABLE_SIZE, DAC_WIDTH, 16 bytes a 0xFF}
+ *  - entrada:  {nombre[NAME_LEN], direccion, CRC32}; libre si dir = 0xFFFFFFFF
+ *
+ * Ejemplo (arranque):
+ *    SpiFlash flash(&spi, 1);
+ *    WaveStore store(&flash, 0x1000000);
+ *    if (SpiFlash::known_id(flash.read_id()) && store.mount())
+ *       store.load(store.find("triangulo"), &dds, true);
+ *
+ * Ejemplo (programacion de la biblioteca):
+ *    if (store.format())
+ *       store.add("triangulo", AWG_TRIANGLE.sample);
+ **********************************************************************/
+
+/**
+ * entrada del directorio.
+ */
+struct WaveEntry {
+   char name[24];      /**< nombre terminado en 0 */
+   uint32_t addr;      /**< direccion de los datos en la flash */
+   uint32_t crc;       /**< DdsAwgCore::awg_crc32() de la tabla */
+};
+
+class WaveStore {
+public:
+   enum {
+      MAGIC       = 0x53475741,   /**< "AWGS" en little-endian */
+      VERSION     = 1,
+      NAME_LEN    = 24,           /**< bytes de nombre (incluido el 0) */
+      ENTRY_SIZE  = 32,
+      DIR_START   = 32,           /**< primera entrada (tras la cabecera) */
+      MAX_WAVES   = (SpiFlash::SECTOR_SIZE - DIR_START) / ENTRY_SIZE,
+      DATA_START  = SpiFlash::SECTOR_SIZE,
+      PACKED_SIZE = DdsAwgCore::TABLE_SIZE / 4 * 7,   /**< 1792 bytes */
+      BOUNCE_SIZE = 56            /**< bytes por bloque (32 muestras) */
+   };
+
+   /**
+    * constructor.
+    * @param flash_p puntero a la flash
+    * @param size tamano de la flash en bytes
+    */
+   WaveStore(SpiFlash *flash_p, uint32_t size);
+   ~WaveStore();
+
+   /**
+    * lee la cabecera y recorre el directorio.
+    * @return true si la flash contiene una biblioteca valida
+    */
+   bool mount();
+
+   /**
+    * crea una biblioteca vacia (borra el sector del directorio).
+    * @return false si la flash no completa el borrado o la programacion
+    */
+   bool format();
+
+   /**
+    * formas de onda guardadas.
+    * @return # entradas (0 si no esta montada)
+    */
+   int count();
+
+   /**
+    * lee una entrada del directorio.
+    * @param idx indice (0..count()-1)
+    * @param e entrada leida
+    * @return true si idx es valido
+    */
+   bool get_entry(int idx, WaveEntry *e);
+
+   /**
+    * busca una forma de onda por nombre.
+    * @param name nombre
+    * @return indice, -1 si no existe
+    */
+   int find(const char *name);
+
+   /**
+    * anade una forma de onda al final de la biblioteca.
+    * @param name nombre (se trunca a NAME_LEN-1 caracteres)
+    * @param table TABLE_SIZE muestras (0..DAC_MAX)
+    * @return indice de la entrada, -1 si no cabe, no esta montada o la
+    *         flash falla (la entrada no se escribe y la biblioteca queda
+    *         desmontada hasta el siguiente mount())
+    */
+   int add(const char *name, const uint16_t *table);
+
+   /**
+    * carga una forma de onda en el banco AWG libre por flujo.
+    * @param idx indice (0..count()-1)
+    * @param dds_p canal destino
+    * @param play true para conmutar al banco cargado si es correcto
+    * @return true si los CRC del hardware y del directorio coinciden
+    */
+   bool load(int idx, DdsAwgCore *dds_p, bool play);
+
+   /**
+    * empaqueta 4 muestras de 14 bits en 7 bytes.
+    * @param s muestras
+    * @param out 7 bytes
+    */
+   static void pack4(const uint16_t *s, uint8_t *out);
+
+   /**
+    * desempaqueta 7 bytes en 4 muestras de 14 bits.
+    * @param in 7 bytes
+    * @param s muestras
+    */
+   static void unpack4(const uint8_t *in, uint16_t *s);
+
+private:
+   SpiFlash *flash_p;
+   uint32_t size;
+   int n;               // entradas en el directorio (-1: no montada)
+   uint32_t data_end;   // primer byte libre de la zona de datos
+};
+
+#endif  // _WAVE_STORE_H_INCLUDED
@@ -0,0 +1,43 @@
+#include <string.h>
+#include "host_bus.h"
+#include "bench_suite.h"
+#include "uart_core.h"
+#include "spi_core.h"
+#include "dds_awg_core.h"
+#include "spi_flash.h"
+#include "wave_store.h"
+#include "awg_waveforms.h"
+
+/**********************************************************************
+ * bench_suite() en el host contra el bus simulado (make bench): sirve
+ * para comprobar que los benchmarks compilan y terminan sin hardware y
+ * para comparar versiones por accesos al bus (1 ciclo = 1 acceso; no
+ * son tiempos del MicroBlaze). La salida de la uart va a stdout.
+ * La biblioteca de la flash se programa aqui antes de la suite, como
+ * haria el paso de programacion en la placa: bench_suite() no escribe
+ * nunca en la flash.
+ **********************************************************************/
+static const uint32_t FLASH_SIZE = 0x100000;   // 1 MB, borrada
+static uint8_t flash_mem[FLASH_SIZE];
+
+SpiCore spi(get_slot_addr(BRIDGE_BASE, S4_SPI));
+UartCore uart(get_slot_addr(BRIDGE_BASE, S3_UART));
+DdsAwgCore dds(get_slot_addr(BRIDGE_BASE, S5_DDS_AWG));
+SpiFlash flash(&spi, 1);
+WaveStore wstore(&flash, FLASH_SIZE);
+
+int main() {
+   memset(flash_mem, 0xFF, sizeof(flash_mem));
+   host_flash_attach(1, flash_mem, FLASH_SIZE, 0x20BA18, 4);
+   host_uart_echo(true);
+   if (wstore.format()) {
+      wstore.add("square25", AWG_SQUARE_25.sample);
+      wstore.add("square50", AWG_SQUARE_50.sample);
+      wstore.add("square75", AWG_SQUARE_75.sample);
+      wstore.add("triangle", AWG_TRIANGLE.sample);
+      wstore.add("sawtooth", AWG_SAWTOOTH.sample);
+   }
+   bench_suite(&dds, &spi, &flash, &wstore, &uart);
+   uart.flush();
+   return 0;
+}
@@ -0,0 +1,613 @@
+#include <stdio.h>
+#include <string.h>
+#include "host_bus.h"
+#include "io_map.h"
+#include "io_rw.h"
+#include "timer_core.h"
+#include "spi_core.h"
+#include "dds_awg_core.h"
+#include "spi_flash.h"
+
+/**********************************************************************
+ * Estado de los modelos: solo tipos POD a cero (inicializacion estatica,
+ * anterior a los constructores globales que ya escriben en el bus)
+ **********************************************************************/
+static const int NUM_SLOTS = 14;
+static const int NUM_SS = 2;
+static const int NUM_BANKS = 4;
+static const int TABLE_SIZE = DdsAwgCore::TABLE_SIZE;
+static const uint64_t COUNTER_MASK = (1ULL << 48) - 1;
+
+// mapas de registros del timer y la uart (privados en sus drivers)
+enum {
+   T_COUNTER_LOWER = 0, T_COUNTER_UPPER = 1, T_CTRL = 2, T_CMP0 = 4,
+   T_STRIDE = 4,                                  // CMP, PERIOD, STAT por canal
+   T_GO = 0x01, T_CLR = 0x02,                     // CTRL
+   T_MATCH = 0x01, T_OVR = 0x02, T_ARMED = 0x04   // STAT
+};
+
+enum {
+   U_RD_DATA = 0, U_WR_DATA = 2, U_RM_RD_DATA = 3, U_RX_POP = 4,
+   U_RX_EMPT = 0x100, U_RX_VALID = 0x100
+};
+
+static uint64_t tick;
+static uint32_t regs[NUM_SLOTS][32];   // slots sin modelo
+
+struct Alarm {
+   uint32_t cmp;
+   uint32_t period;
+   uint32_t stat;      // MATCH | OVR
+   bool armed;
+};
+
+struct Timer {
+   uint64_t base;      // tick del ultimo clear
+   uint64_t frozen;    // cuenta con GO a 0
+   bool stopped;
+   uint32_t upper;     // capturado al leer LOWER
+   Alarm alarm[TimerCore::NUM_ALARMS];
+};
+
+struct Uart {
+   uint8_t rx[4096];
+   uint32_t rx_head, rx_tail;
+   uint8_t tx[65536];
+   uint32_t tx_head, tx_tail;
+   bool echo;
+};
+
+struct Flash {
+   uint8_t *mem;
+   uint32_t size;
+   uint32_t id;
+   int busy_polls;     // lecturas de estado con WIP tras programar/borrar
+   int busy;           // lecturas pendientes (< 0: siempre ocupada)
+   bool wel;
+   int k;              // byte dentro del comando
+   uint8_t op;
+   uint32_t addr;
+};
+
+struct Spi {
+   uint32_t ctrl;
+   uint32_t ss_n;
+   uint32_t rx[16];
+   int rx_head, rx_count;
+   Flash flash[NUM_SS];
+};
+
+struct Dds {
+   uint32_t fcw, pow, ctrl;            // escritos (sombra)
+   uint32_t fcw_cm, pow_cm, ctrl_cm;   // capturados por el COMMIT
+   uint32_t fcw_act, pow_act, ctrl_act;
+   bool armed;                         // COMMIT esperando SYNC
+   int commits;
+   uint16_t ram[NUM_BANKS][TABLE_SIZE];
+   uint32_t ram_addr;
+   int bank_wr, bank_play;
+   uint32_t crc_wr, crc_scan;
+};
+
+static Timer timer;
+static Uart uart;
+static Spi spi;
+static Dds dds[2];
+
+/**********************************************************************
+ * CRC32 IEEE (reflejado) de cada muestra como 16 bits little endian;
+ * mismo calculo que el hardware, bit a bit
+ **********************************************************************/
+static uint32_t crc32_sample(uint32_t crc, uint16_t s) {
+   crc ^= s;
+   for (int i = 0; i < 16; i++)
+      crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320u : 0);
+   return crc;
+}
+
+/**********************************************************************
+ * timer
+ **********************************************************************/
+static uint64_t timer_count() {
+   return (timer.stopped ? timer.frozen : tick - timer.base) & COUNTER_MASK;
+}
+
+// vence las alarmas armadas hasta la cuenta actual
+static void timer_update() {
+   uint32_t now = (uint32_t) timer_count();
+
+   for (int ch = 0; ch < TimerCore::NUM_ALARMS; ch++) {
+      Alarm *a = &timer.alarm[ch];
+      while (a->armed && (int32_t) (now - a->cmp) >= 0) {
+         if (a->stat & T_MATCH)
+            a->stat |= T_OVR;
+         a->stat |= T_MATCH;
+         if (a->period)
+            a->cmp += a->period;
+         else
+            a->armed = false;
+      }
+   }
+}
+
+static uint32_t timer_read(int reg) {
+   uint64_t cnt;
+   uint32_t st;
+   Alarm *a;
+
+   timer_update();
+   switch (reg) {
+   case T_COUNTER_LOWER:
+      cnt = timer_count();
+      timer.upper = (uint32_t) (cnt >> 32);
+      return (uint32_t) cnt;
+   case T_COUNTER_UPPER:
+      return timer.upper;
+   }
+   if (reg >= T_CMP0
+       && reg < T_CMP0 + TimerCore::NUM_ALARMS * T_STRIDE) {
+      a = &timer.alarm[(reg - T_CMP0) / T_STRIDE];
+      switch ((reg - T_CMP0) % T_STRIDE) {
+      case 0:
+         return a->cmp;
+      case 1:
+         return a->period;
+      case 2:
+         st = a->stat | (a->armed ? T_ARMED : 0);
+         a->stat = 0;
+         return st;
+      }
+   }
+   return 0;
+}
+
+static void timer_write(int reg, uint32_t data) {
+   Alarm *a;
+
+   if (reg == T_CTRL) {
+      if (data & T_CLR) {
+         timer.base = tick;
+         timer.frozen = 0;
+      }
+      if (!(data & T_GO) && !timer.stopped) {
+         timer.frozen = timer_count();
+         timer.stopped = true;
+      } else if ((data & T_GO) && timer.stopped) {
+         timer.base = tick - timer.frozen;
+         timer.stopped = false;
+      }
+      return;
+   }
+   if (reg >= T_CMP0
+       && reg < T_CMP0 + TimerCore::NUM_ALARMS * T_STRIDE) {
+      timer_update();
+      a = &timer.alarm[(reg - T_CMP0) / T_STRIDE];
+      switch ((reg - T_CMP0) % T_STRIDE) {
+      case 0:
+         a->cmp = data;
+         a->armed = true;
+         break;
+      case 1:
+         a->period = data;
+         break;
+      case 2:
+         a->armed = false;
+         break;
+      }
+   }
+}
+
+/**********************************************************************
+ * uart
+ **********************************************************************/
+static int uart_rx_level() {
+   return (int) ((uart.rx_head - uart.rx_tail) % sizeof(uart.rx));
+}
+
+static uint32_t uart_level_field() {
+   int n = uart_rx_level();
+   return (uint32_t) (n > 31 ? 31 : n) << 16;
+}
+
+static uint32_t uart_read(int reg) {
+   uint32_t d;
+
+   switch (reg) {
+   case U_RD_DATA:
+      if (uart_rx_level() == 0)
+         return U_RX_EMPT;
+      return uart_level_field() | uart.rx[uart.rx_tail];
+   case U_RX_POP:
+      if (uart_rx_level() == 0)
+         return 0;
+      d = U_RX_VALID | uart_level_field() | uart.rx[uart.rx_tail];
+      uart.rx_tail = (uart.rx_tail + 1) % sizeof(uart.rx);
+      return d;
+   }
+   return 0;
+}
+
+static void uart_write(int reg, uint32_t data) {
+   switch (reg) {
+   case U_WR_DATA:
+      uart.tx[uart.tx_head] = (uint8_t) data;
+      uart.tx_head = (uart.tx_head + 1) % sizeof(uart.tx);
+      if (uart.tx_head == uart.tx_tail)   // lleno: se pierde lo mas antiguo
+         uart.tx_tail = (uart.tx_tail + 1) % sizeof(uart.tx);
+      if (uart.echo)
+         putchar((int) (uint8_t) data);
+      break;
+   case U_RM_RD_DATA:
+      if (uart_rx_level() > 0)
+         uart.rx_tail = (uart.rx_tail + 1) % sizeof(uart.rx);
+      break;
+   }
+}
+
+/**********************************************************************
+ * flash SPI NOR (un byte por transferencia, ss activo durante el comando)
+ **********************************************************************/
+static void flash_select(Flash *f) {
+   f->k = 0;
+}
+
+static void flash_deselect(Flash *f) {
+   uint32_t base;
+
+   if (f->k >= 4 && f->wel
+       && (f->op == SpiFlash::CMD_PAGE_PROGRAM || f->op == SpiFlash::CMD_SECTOR_ERASE)) {
+      if (f->op == SpiFlash::CMD_SECTOR_ERASE) {
+         base = f->addr & ~(uint32_t) (SpiFlash::SECTOR_SIZE - 1);
+         memset(f->mem + base, 0xFF, SpiFlash::SECTOR_SIZE);
+      }
+      f->wel = false;
+      f->busy = f->busy_polls;
+   }
+   f->k = 0;
+}
+
+static uint8_t flash_shift(Flash *f, uint8_t mosi) {
+   uint8_t miso = 0xFF;
+   int k = f->k++;
+
+   if (k == 0) {
+      f->op = mosi;
+      f->addr = 0;
+      if (f->busy != 0 && mosi != SpiFlash::CMD_READ_STATUS)
+         f->op = 0;   // ocupada: solo atiende la lectura de estado
+      else if (mosi == SpiFlash::CMD_WRITE_ENABLE)
+         f->wel = true;
+      return miso;
+   }
+   switch (f->op) {
+   case SpiFlash::CMD_READ_ID:
+      if (k <= 3)
+         miso = (uint8_t) (f->id >> (8 * (3 - k)));
+      break;
+   case SpiFlash::CMD_READ_STATUS:
+      miso = (f->busy != 0 ? SpiFlash::STATUS_WIP_FIELD : 0) | (f->wel ? 0x02 : 0);
+      if (f->busy > 0)
+         f->busy--;
+      break;
+   case SpiFlash::CMD_FAST_READ:
+   case SpiFlash::CMD_PAGE_PROGRAM:
+   case SpiFlash::CMD_SECTOR_ERASE:
+      if (k <= 3) {
+         f->addr = ((f->addr << 8) | mosi) % f->size;
+         break;
+      }
+      if (f->op == SpiFlash::CMD_FAST_READ && k >= 5) {
+         miso = f->mem[f->addr];
+         f->addr = (f->addr + 1) % f->size;
+      } else if (f->op == SpiFlash::CMD_PAGE_PROGRAM && f->wel) {
+         // la pagina da la vuelta; programar solo pasa bits a 0
+         f->mem[f->addr] &= mosi;
+         f->addr = (f->addr & ~(uint32_t) (SpiFlash::PAGE_SIZE - 1))
+                 | ((f->addr + 1) & (SpiFlash::PAGE_SIZE - 1));
+      }
+      break;
+   }
+   return miso;
+}
+
+/**********************************************************************
+ * spi
+ **********************************************************************/
+static uint32_t spi_rx_level_field() {
+   return (uint32_t) spi.rx_count << 16;
+}
+
+static uint32_t spi_pop() {
+   uint32_t d = spi.rx[spi.rx_head];
+
+   spi.rx_head = (spi.rx_head + 1) % SpiCore::FIFO_DEPTH;
+   spi.rx_count--;
+   return d;
+}
+
+static uint32_t spi_read(int reg) {
+   uint32_t d;
+
+   switch (reg) {
+   case SpiCore::RD_DATA_REG:
+      d = SpiCore::READY_FIELD | spi_rx_level_field();
+      if (spi.rx_count == 0)
+         return d | SpiCore::RX_EMPTY_FIELD;
+      return d | (spi.rx[spi.rx_head] & SpiCore::RX_DATA_FIELD);
+   case SpiCore::RX_POP_REG:
+      if (spi.rx_count == 0)
+         return 0;
+      d = spi_rx_level_field();
+      return d | SpiCore::RX_VALID_FIELD | (spi_pop() & SpiCore::RX_DATA_FIELD);
+   case SpiCore::RX_WORD_REG:
+      return spi.rx_count ? spi_pop() : 0;
+   }
+   return 0;
+}
+
+static void spi_write(int reg, uint32_t data) {
+   int nbits, ss;
+   uint32_t miso, changed;
+
+   switch (reg) {
+   case SpiCore::CTRL_REG:
+      spi.ctrl = data;
+      break;
+   case SpiCore::SS_REG:
+      changed = spi.ss_n ^ data;
+      spi.ss_n = data;
+      for (ss = 0; ss < NUM_SS; ss++) {
+         if (!((changed >> ss) & 1) || !spi.flash[ss].mem)
+            continue;
+         if ((data >> ss) & 1)
+            flash_deselect(&spi.flash[ss]);
+         else
+            flash_select(&spi.flash[ss]);
+      }
+      break;
+   case SpiCore::WR_DATA_REG:
+      nbits = (int) ((spi.ctrl & SpiCore::NBITS_FIELD) >> 24) + 1;
+      miso = nbits == 32 ? 0xFFFFFFFF : (1u << nbits) - 1;
+      for (ss = 0; ss < NUM_SS; ss++)
+         if (!((spi.ss_n >> ss) & 1) && spi.flash[ss].mem && nbits == 8)
+            miso = flash_shift(&spi.flash[ss], (uint8_t) data);
+      if (!(spi.ctrl & SpiCore::RX_DIS_FIELD) && spi.rx_count < SpiCore::FIFO_DEPTH) {
+         spi.rx[(spi.rx_head + spi.rx_count) % SpiCore::FIFO_DEPTH] = miso;
+         spi.rx_count++;
+      }
+      break;
+   }
+}
+
+/**********************************************************************
+ * dds
+ **********************************************************************/
+static void dds_apply(Dds *d) {
+   d->fcw_act = d->fcw_cm;
+   d->pow_act = d->pow_cm;
+   d->ctrl_act = d->ctrl_cm;
+   d->armed = false;
+}
+
+static void dds_ram_write(Dds *d, uint32_t s) {
+   s &= DdsAwgCore::DAC_MAX;
+   d->ram[d->bank_wr][d->ram_addr] = (uint16_t) s;
+   d->crc_wr = crc32_sample(d->crc_wr, (uint16_t) s);
+   d->ram_addr = (d->ram_addr + 1) & (TABLE_SIZE - 1);
+}
+
+static uint32_t dds_read(Dds *d, int reg) {
+   switch (reg) {
+   case DdsAwgCore::FCW_REG:
+      return d->fcw;
+   case DdsAwgCore::STATUS_REG:
+      return (d->armed ? 0 : DdsAwgCore::UPDATE_DONE_FIELD)
+           | ((uint32_t) d->bank_play << 4);
+   case DdsAwgCore::CRC_WR_REG:
+      return ~d->crc_wr;
+   case DdsAwgCore::CRC_SCAN_REG:
+      return d->crc_scan;
+   }
+   return 0;
+}
+
+static void dds_write(Dds *d, int reg, uint32_t data) {
+   uint32_t crc;
+   int i;
+
+   switch (reg) {
+   case DdsAwgCore::FCW_REG:
+      d->fcw = data;
+      break;
+   case DdsAwgCore::CTRL_REG:
+      d->ctrl = data;
+      break;
+   case DdsAwgCore::POW_REG:
+      d->pow = data;
+      break;
+   case DdsAwgCore::RAM_ADDR_REG:
+      d->ram_addr = data & (TABLE_SIZE - 1);
+      break;
+   case DdsAwgCore::RAM_DATA_REG:
+      dds_ram_write(d, data);
+      break;
+   case DdsAwgCore::RAM_PAIR_REG:
+      dds_ram_write(d, data);
+      dds_ram_write(d, data >> 16);
+      break;
+   case DdsAwgCore::BANK_WR_REG:
+      d->bank_wr = (int) (data & (NUM_BANKS - 1));
+      break;
+   case DdsAwgCore::BANK_PLAY_REG:
+      d->bank_play = (int) (data & (NUM_BANKS - 1));
+      break;
+   case DdsAwgCore::COMMIT_REG:
+      // como el hardware: se ignora mientras el anterior no se aplica
+      if (d->armed)
+         break;
+      d->commits++;
+      d->fcw_cm = d->fcw;
+      d->pow_cm = d->pow;
+      d->ctrl_cm = d->ctrl;
+      // Phase Rst y Sync Wait se auto-borran en la sombra
+      d->ctrl &= ~(uint32_t) (DdsAwgCore::PHASE_RST_FIELD | DdsAwgCore::SYNC_WAIT_FIELD);
+      if (d->ctrl_cm & DdsAwgCore::SYNC_WAIT_FIELD)
+         d->armed = true;
+      else
+         dds_apply(d);
+      break;
+   case DdsAwgCore::SYNC_REG:
+      // solo el maestro genera el pulso, que llega a todos los canales
+      if (d != &dds[0])
+         break;
+      for (i = 0; i < 2; i++)
+         if (dds[i].armed)
+            dds_apply(&dds[i]);
+      break;
+   case DdsAwgCore::CRC_WR_REG:
+      d->crc_wr = 0xFFFFFFFF;
+      break;
+   case DdsAwgCore::CRC_SCAN_REG:
+      crc = 0xFFFFFFFF;
+      for (i = 0; i < TABLE_SIZE; i++)
+         crc = crc32_sample(crc, d->ram[d->bank_wr][i]);
+      d->crc_scan = ~crc;
+      break;
+   }
+}
+
+static Dds *dds_slot(int slot) {
+   return &dds[slot == S6_DDS_AWG1 ? 1 : 0];
+}
+
+/**********************************************************************
+ * bus
+ **********************************************************************/
+uint32_t host_io_read(uint32_t addr) {
+   uint32_t off = addr - BRIDGE_BASE;
+   int slot = (int) (off >> 7) % NUM_SLOTS;
+   int reg = (int) (off >> 2) & 31;
+
+   tick++;
+   switch (slot) {
+   case S0_TIMER:
+      return timer_read(reg);
+   case S3_UART:
+      return uart_read(reg);
+   case S4_SPI:
+      return spi_read(reg);
+   case S5_DDS_AWG:
+   case S6_DDS_AWG1:
+      return dds_read(dds_slot(slot), reg);
+   }
+   return regs[slot][reg];
+}
+
+void host_io_write(uint32_t addr, uint32_t data) {
+   uint32_t off = addr - BRIDGE_BASE;
+   int slot = (int) (off >> 7) % NUM_SLOTS;
+   int reg = (int) (off >> 2) & 31;
+
+   tick++;
+   switch (slot) {
+   case S0_TIMER:
+      timer_write(reg, data);
+      return;
+   case S3_UART:
+      uart_write(reg, data);
+      return;
+   case S4_SPI:
+      spi_write(reg, data);
+      return;
+   case S5_DDS_AWG:
+   case S6_DDS_AWG1:
+      dds_write(dds_slot(slot), reg, data);
+      return;
+   }
+   regs[slot][reg] = data;
+}
+
+/**********************************************************************
+ * control desde las pruebas
+ **********************************************************************/
+void host_bus_reset() {
+   bool echo = uart.echo;
+
+   memset(regs, 0, sizeof(regs));
+   memset(&timer, 0, sizeof(timer));
+   timer.base = tick;
+   memset(&uart, 0, sizeof(uart));
+   uart.echo = echo;
+   memset(&spi, 0, sizeof(spi));
+   spi.ss_n = 0xFFFFFFFF;
+   memset(dds, 0, sizeof(dds));
+}
+
+uint64_t host_tick() {
+   return tick;
+}
+
+void host_advance(uint64_t ticks) {
+   tick += ticks;
+}
+
+void host_uart_rx(const uint8_t *buf, size_t n) {
+   for (size_t i = 0; i < n; i++) {
+      uart.rx[uart.rx_head] = buf[i];
+      uart.rx_head = (uart.rx_head + 1) % sizeof(uart.rx);
+   }
+}
+
+size_t host_uart_tx(uint8_t *buf, size_t max) {
+   size_t n = 0;
+
+   while (n < max && uart.tx_tail != uart.tx_head) {
+      buf[n++] = uart.tx[uart.tx_tail];
+      uart.tx_tail = (uart.tx_tail + 1) % sizeof(uart.tx);
+   }
+   return n;
+}
+
+void host_uart_echo(bool on) {
+   uart.echo = on;
+}
+
+void host_flash_attach(int ss, uint8_t *mem, uint32_t size, uint32_t jedec_id, int busy_polls) {
+   Flash *f = &spi.flash[ss];
+
+   memset(f, 0, sizeof(*f));
+   f->mem = mem;
+   f->size = size;
+   f->id = jedec_id;
+   f->busy_polls = busy_polls;
+}
+
+void host_spi_detach(int ss) {
+   memset(&spi.flash[ss], 0, sizeof(spi.flash[ss]));
+}
+
+uint32_t host_dds_active(int slot, int reg) {
+   Dds *d = dds_slot(slot);
+
+   switch (reg) {
+   case DdsAwgCore::FCW_REG:
+      return d->fcw_act;
+   case DdsAwgCore::POW_REG:
+      return d->pow_act;
+   case DdsAwgCore::CTRL_REG:
+      return d->ctrl_act;
+   }
+   return 0;
+}
+
+int host_dds_play_bank(int slot) {
+   return dds_slot(slot)->bank_play;
+}
+
+const uint16_t *host_dds_ram(int slot, int bank) {
+   return dds_slot(slot)->ram[bank & (NUM_BANKS - 1)];
+}
+
+int host_dds_commits(int slot) {
+   return dds_slot(slot)->commits;
+}
@@ -0,0 +1,113 @@
+#ifndef _HOST_BUS_H_INCLUDED
+#define _HOST_BUS_H_INCLUDED
+#include <stddef.h>
+#include <inttypes.h>
+
+/**********************************************************************
+ * Bus de E/S simulado para compilar el firmware en el host (-D_HOST_IO,
+ * ver io_rw.h): host_io_read()/host_io_write() reparten los accesos por
+ * slot (io_map.h) entre modelos sencillos de cada core
+ *  - S0 timer: contador de 48 bits que avanza 1 tick por acceso al bus
+ *    (los "ciclos" de un benchmark en el host son accesos al bus), con
+ *    los canales de alarma (CMP/PERIOD/STAT) y host_advance() para
+ *    simular esperas
+ *  - S3 uart: lo transmitido se guarda (host_uart_tx) y opcionalmente se
+ *    copia a stdout; lo recibido se inyecta con host_uart_rx()
+ *  - S4 spi: desplazamiento instantaneo; sin dispositivo en el ss activo
+ *    MISO lee todo unos (linea sin pull-up, peor caso); host_flash_attach()
+ *    conecta una NOR serie 25 (comandos de SpiFlash)
+ *  - S5/S6 dds: registros, 4 bancos de RAM AWG, CRC32 de las escrituras
+ *    y del banco (CRC_WR/CRC_SCAN), conmutacion de banco y COMMIT
+ *    inmediatos (SYNC_WAIT espera al SYNC del maestro S5; SYNC en S6 no
+ *    hace nada y un COMMIT con otro armado se ignora)
+ *  - resto de slots: registros de lectura/escritura sin efectos
+ * El estado es estatico y se inicializa a cero antes que los
+ * constructores globales del firmware (init.cpp).
+ **********************************************************************/
+
+/**
+ * vuelve todos los modelos al estado inicial (no el tick).
+ */
+void host_bus_reset();
+
+/**
+ * ticks del timer simulado desde el arranque.
+ * @return ticks (accesos al bus + host_advance())
+ */
+uint64_t host_tick();
+
+/**
+ * avanza el timer simulado (p.ej. para vencer un timeout).
+ * @param ticks ciclos de SYS_CLK_FREQ
+ */
+void host_advance(uint64_t ticks);
+
+/**
+ * encola bytes en la rx FIFO de la uart.
+ * @param buf datos
+ * @param n # bytes
+ */
+void host_uart_rx(const uint8_t *buf, size_t n);
+
+/**
+ * extrae lo transmitido por la uart desde la llamada anterior.
+ * @param buf destino
+ * @param max tamano de buf
+ * @return # bytes copiados
+ */
+size_t host_uart_tx(uint8_t *buf, size_t max);
+
+/**
+ * copia (o no) a stdout cada byte transmitido por la uart.
+ * @param on true: copiar
+ */
+void host_uart_echo(bool on);
+
+/**
+ * conecta una flash SPI NOR en un slave select.
+ * @param ss slave select
+ * @param mem contenido de la flash, propiedad del llamador
+ * @param size tamano en bytes (multiplo de 4 KB)
+ * @param jedec_id identificador devuelto por 0x9F (bits 23..0)
+ * @param busy_polls lecturas de estado con WIP a 1 tras cada
+ *        programacion o borrado (< 0: la flash no termina nunca)
+ */
+void host_flash_attach(int ss, uint8_t *mem, uint32_t size, uint32_t jedec_id, int busy_polls);
+
+/**
+ * desconecta el dispositivo de un slave select (MISO vuelve a unos).
+ * @param ss slave select
+ */
+void host_spi_detach(int ss);
+
+/**
+ * lee un registro del modelo dds tal y como lo ve el datapath (valores
+ * aplicados por el ultimo COMMIT): FCW_REG, POW_REG, CTRL_REG.
+ * @param slot S5_DDS_AWG o S6_DDS_AWG1
+ * @param reg registro (DdsAwgCore::*_REG)
+ * @return valor aplicado
+ */
+uint32_t host_dds_active(int slot, int reg);
+
+/**
+ * banco AWG en reproduccion.
+ * @param slot S5_DDS_AWG o S6_DDS_AWG1
+ * @return banco 0..3
+ */
+int host_dds_play_bank(int slot);
+
+/**
+ * RAM AWG de un banco.
+ * @param slot S5_DDS_AWG o S6_DDS_AWG1
+ * @param bank banco 0..3
+ * @return TABLE_SIZE muestras
+ */
+const uint16_t *host_dds_ram(int slot, int bank);
+
+/**
+ * # COMMIT escritos en el canal desde host_bus_reset().
+ * @param slot S5_DDS_AWG o S6_DDS_AWG1
+ */
+int host_dds_commits(int slot);
+
+#endif  // _HOST_BUS_H_INCLUDED
@@ -0,0 +1,66 @@
+#include "link_client.h"
+
+static const uint8_t SOF = 0xA5;
+static const uint8_t OP_REPLY = 0x80;
+
+uint16_t link_crc16(const uint8_t *p, size_t n) {
+   uint16_t c = 0xFFFF;
+
+   for (size_t i = 0; i < n; i++) {
+      c ^= (uint16_t) p[i] << 8;
+      for (int b = 0; b < 8; b++)
+         c = (c & 0x8000) ? (uint16_t) ((c << 1) ^ 0x1021) : (uint16_t) (c << 1);
+   }
+   return c;
+}
+
+void link_put_u32(uint8_t *p, uint32_t v) {
+   for (int i = 0; i < 4; i++)
+      p[i] = (uint8_t) (v >> (8 * i));
+}
+
+size_t link_frame(uint8_t *out, uint8_t op, uint8_t ch, const uint8_t *payload, size_t len) {
+   uint16_t c;
+
+   out[0] = SOF;
+   out[1] = (uint8_t) len;
+   out[2] = (uint8_t) (len >> 8);
+   out[3] = op;
+   out[4] = ch;
+   for (size_t i = 0; i < len; i++)
+      out[5 + i] = payload[i];
+   // el CRC cubre LEN..PAYLOAD (sin el SOF)
+   c = link_crc16(out + 1, len + 4);
+   out[5 + len] = (uint8_t) c;
+   out[6 + len] = (uint8_t) (c >> 8);
+   return len + LINK_OVERHEAD;
+}
+
+size_t link_batch_add(uint8_t *payload, size_t len, uint8_t sub, uint32_t val) {
+   payload[len] = sub;
+   link_put_u32(payload + len + 1, val);
+   return len + 5;
+}
+
+size_t link_awg_payload(uint8_t *payload, const uint16_t *table, size_t n) {
+   for (size_t i = 0; i < n; i++) {
+      payload[2 * i] = (uint8_t) table[i];
+      payload[2 * i + 1] = (uint8_t) (table[i] >> 8);
+   }
+   return 2 * n;
+}
+
+bool link_parse_reply(const uint8_t *p, size_t n, LinkReply *r) {
+   uint16_t c;
+
+   if (n < (size_t) LINK_REPLY_SIZE || p[0] != SOF || p[1] != 1 || p[2] != 0
+       || !(p[3] & OP_REPLY))
+      return false;
+   c = (uint16_t) p[6] | ((uint16_t) p[7] << 8);
+   if (c != link_crc16(p + 1, 5))
+      return false;
+   r->op = p[3] & (uint8_t) ~OP_REPLY;
+   r->ch = p[4];
+   r->status = p[5];
+   return true;
+}
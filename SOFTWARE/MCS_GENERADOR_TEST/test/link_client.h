@@ -0,0 +1,87 @@
+#ifndef _LINK_CLIENT_H_INCLUDED
+#define _LINK_CLIENT_H_INCLUDED
+#include <stddef.h>
+#include <inttypes.h>
+
+/**********************************************************************
+ * Cliente de referencia del protocolo DdsLink (lado host, ver
+ * dds_link.h): construye tramas y comprueba respuestas sin depender del
+ * firmware, asi que sirve de especificacion ejecutable para un cliente
+ * en el PC y de generador de tramas para test_dds_link
+ *  - link_crc16(): CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+ *  - link_frame(): SOF | LEN | OP | CH | PAYLOAD | CRC, little-endian
+ *  - link_batch_add(), link_awg_payload(): payloads de OP_BATCH y
+ *    OP_AWG_LOAD
+ *  - link_parse_reply(): valida una respuesta de 8 bytes
+ *
+ * Ejemplo:
+ *    uint8_t f[LINK_FRAME_MAX], p[4];
+ *    link_put_u32(p, 0x01000000);
+ *    n = link_frame(f, 0x10, 0, p, 4);   // OP_SET_FCW, canal 0
+ **********************************************************************/
+
+static const int LINK_OVERHEAD = 7;                    // SOF, LEN, OP, CH, CRC
+static const int LINK_FRAME_MAX = 2 * 1024 + LINK_OVERHEAD;
+static const int LINK_REPLY_SIZE = 8;
+
+struct LinkReply {
+   uint8_t op;       // opcode original (sin OP_REPLY)
+   uint8_t ch;
+   uint8_t status;
+};
+
+/**
+ * CRC-16/CCITT-FALSE.
+ * @param p datos
+ * @param n # bytes
+ * @return CRC
+ */
+uint16_t link_crc16(const uint8_t *p, size_t n);
+
+/**
+ * escribe v en little-endian.
+ * @param p destino (4 bytes)
+ * @param v valor
+ */
+void link_put_u32(uint8_t *p, uint32_t v);
+
+/**
+ * construye una trama completa.
+ * @param out destino (len + LINK_OVERHEAD bytes)
+ * @param op opcode
+ * @param ch canal
+ * @param payload datos (puede ser 0 con len 0)
+ * @param len # bytes de payload (< 65536)
+ * @return # bytes de la trama
+ */
+size_t link_frame(uint8_t *out, uint8_t op, uint8_t ch, const uint8_t *payload, size_t len);
+
+/**
+ * anade un registro {sub-op, u32} a un payload de OP_BATCH.
+ * @param payload destino
+ * @param len bytes ya escritos
+ * @param sub sub-op (OP_SET_FCW/POW/ENABLE/WAVE)
+ * @param val valor
+ * @return nuevo len (len + 5)
+ */
+size_t link_batch_add(uint8_t *payload, size_t len, uint8_t sub, uint32_t val);
+
+/**
+ * payload de OP_AWG_LOAD: n muestras u16 little-endian.
+ * @param payload destino (2n bytes)
+ * @param table muestras
+ * @param n # muestras
+ * @return 2n
+ */
+size_t link_awg_payload(uint8_t *payload, const uint16_t *table, size_t n);
+
+/**
+ * valida una respuesta (SOF, LEN = 1, bit de respuesta y CRC).
+ * @param p bytes recibidos
+ * @param n # bytes
+ * @param r respuesta decodificada
+ * @return true si es una respuesta valida
+ */
+bool link_parse_reply(const uint8_t *p, size_t n, LinkReply *r);
+
+#endif  // _LINK_CLIENT_H_INCLUDED
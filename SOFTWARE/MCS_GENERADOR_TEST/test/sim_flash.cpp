@@ -0,0 +1,14 @@
+#include "sim_flash.h"
+#include "host_bus.h"
+
+static SpiCore sim_spi(get_slot_addr(BRIDGE_BASE, S4_SPI));
+
+SimFlash::SimFlash(uint8_t *mem, uint32_t size) : SpiFlash(&sim_spi, SS) {
+   sim_spi.set_mode(0, 0);
+   sim_spi.set_width(8);
+   host_flash_attach(SS, mem, size, JEDEC_N25Q128, 0);
+}
+
+SimFlash::~SimFlash() {
+   host_spi_detach(SS);
+}
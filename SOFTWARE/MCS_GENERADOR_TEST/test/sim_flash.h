@@ -0,0 +1,35 @@
+#ifndef _SIM_FLASH_H_INCLUDED
+#define _SIM_FLASH_H_INCLUDED
+#include "spi_flash.h"
+
+/**********************************************************************
+ * SimFlash: SpiFlash del firmware sobre un array en RAM, para probar en
+ * el host el codigo que usa la flash (p.ej. WaveStore)
+ *  - conecta el array como NOR serie 25 del bus simulado
+ *    (host_flash_attach()) en el slave select SS de un SpiCore propio:
+ *    programar solo pasa bits a 0 y borrar deja 0xFF
+ *  - se identifica como JEDEC_N25Q128 y nunca esta ocupada
+ *  - es el mismo codigo de SpiFlash que va en la imagen del MCS (sin
+ *    metodos virtuales en el firmware)
+ *
+ * Ejemplo:
+ *    static uint8_t mem[0x10000];
+ *    memset(mem, 0xFF, sizeof(mem));
+ *    SimFlash sim(mem, sizeof(mem));
+ *    WaveStore ws(&sim, sizeof(mem));
+ **********************************************************************/
+class SimFlash : public SpiFlash {
+public:
+   static const int SS = 0;   // ss del modelo de flash que ocupa
+
+   /**
+    * constructor.
+    * @param mem memoria que hace de flash, propiedad de la aplicacion
+    * @param size tamano en bytes (multiplo de SECTOR_SIZE)
+    * @note no borra mem: el contenido inicial es el de la "flash"
+    */
+   SimFlash(uint8_t *mem, uint32_t size);
+   ~SimFlash();
+};
+
+#endif  // _SIM_FLASH_H_INCLUDED
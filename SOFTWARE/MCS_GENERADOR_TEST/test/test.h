@@ -0,0 +1,28 @@
+#ifndef _TEST_H_INCLUDED
+#define _TEST_H_INCLUDED
+#include <stdio.h>
+
+/**********************************************************************
+ * Pruebas en el host (ver Makefile)
+ *  - cada prueba es un programa con su main(); CHECK() cuenta los
+ *    fallos e informa del fichero y la linea
+ *  - test_end() imprime el resumen y devuelve el codigo de salida
+ **********************************************************************/
+static int test_fail = 0;
+static int test_count = 0;
+
+#define CHECK(cond)                                                    \
+   do {                                                                \
+      test_count++;                                                    \
+      if (!(cond)) {                                                   \
+         test_fail++;                                                  \
+         printf("%s:%d: fallo: %s\n", __FILE__, __LINE__, #cond);     \
+      }                                                                \
+   } while (0)
+
+static inline int test_end(const char *name) {
+   printf("%s: %d comprobaciones, %d fallos\n", name, test_count, test_fail);
+   return test_fail ? 1 : 0;
+}
+
+#endif  // _TEST_H_INCLUDED
@@ -0,0 +1,53 @@
+#include "test.h"
+#include "awg_waveforms.h"
+
+/**********************************************************************
+ * Tablas AWG predefinidas: flancos de la cuadrada, pico y simetria de
+ * la triangular, monotonia del diente de sierra dentro de DAC_MAX
+ **********************************************************************/
+static const int N = DdsAwgCore::TABLE_SIZE;
+static const int MAX = DdsAwgCore::DAC_MAX;
+
+static void check_square(const AwgWave &w, int duty) {
+   int edge = N * duty / 100;
+
+   // nivel alto hasta el flanco, bajo despues; un solo flanco
+   for (int i = 0; i < N; i++)
+      CHECK(w.sample[i] == ((i < edge) ? MAX : 0));
+   CHECK(w.sample[edge - 1] == MAX && w.sample[edge] == 0);
+}
+
+static void check_triangle(const AwgWave &w) {
+   CHECK(w.sample[0] == 0);
+   CHECK(w.sample[N / 2] == MAX);
+   // simetrica respecto al pico
+   for (int i = 1; i < N / 2; i++)
+      CHECK(w.sample[N / 2 - i] == w.sample[N / 2 + i]);
+   // sube hasta el pico y baja despues
+   for (int i = 1; i <= N / 2; i++)
+      CHECK(w.sample[i] > w.sample[i - 1]);
+   for (int i = N / 2 + 1; i < N; i++)
+      CHECK(w.sample[i] < w.sample[i - 1]);
+}
+
+static void check_sawtooth(const AwgWave &w) {
+   CHECK(w.sample[0] == 0);
+   for (int i = 1; i < N; i++)
+      CHECK(w.sample[i] > w.sample[i - 1]);
+   CHECK(w.sample[N - 1] <= MAX);
+   // el salto de vuelta cubre casi todo el fondo de escala
+   CHECK(w.sample[N - 1] >= MAX - MAX / N - 1);
+}
+
+int main() {
+   check_square(AWG_SQUARE_25, 25);
+   check_square(AWG_SQUARE_50, 50);
+   check_square(AWG_SQUARE_75, 75);
+   check_triangle(AWG_TRIANGLE);
+   check_sawtooth(AWG_SAWTOOTH);
+   // tablas propias en compilacion
+   constexpr AwgWave sq10 = awg_square(10);
+   check_square(sq10, 10);
+   CHECK(awg_in_range(sq10) && awg_in_range(AWG_TRIANGLE) && awg_in_range(AWG_SAWTOOTH));
+   return test_end("awg_waveforms");
+}
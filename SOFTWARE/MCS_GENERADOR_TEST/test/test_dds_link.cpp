@@ -0,0 +1,190 @@
+#include <string.h>
+#include "test.h"
+#include "host_bus.h"
+#include "link_client.h"
+#include "dds_link.h"
+#include "awg_waveforms.h"
+
+/**********************************************************************
+ * Bucle cerrado del protocolo DdsLink: las tramas del cliente de
+ * referencia (link_client.h) entran por la rx FIFO de la uart simulada,
+ * DdsLink::poll() las procesa y las respuestas se leen de la tx; el
+ * efecto se comprueba en los registros aplicados del modelo dds
+ **********************************************************************/
+static const int N = DdsAwgCore::TABLE_SIZE;
+static const uint64_t TIMEOUT_TICKS = (DdsLink::LINK_TIMEOUT_MS + 1) * 1000ULL * SYS_CLK_FREQ;
+
+UartCore uart(get_slot_addr(BRIDGE_BASE, S3_UART));
+DdsAwgCore dds0(get_slot_addr(BRIDGE_BASE, S5_DDS_AWG));
+DdsAwgCore dds1(get_slot_addr(BRIDGE_BASE, S6_DDS_AWG1));
+DdsAwgCore *const chan[2] = {&dds0, &dds1};
+DdsLink link(&uart, chan, 2);
+
+static uint8_t frame[LINK_FRAME_MAX];
+static uint8_t payload[2 * N];
+
+static void send(const uint8_t *f, size_t n) {
+   host_uart_rx(f, n);
+   link.poll();
+}
+
+// la unica respuesta pendiente; status 0xFF si no hay exactamente una
+static LinkReply reply() {
+   uint8_t b[64];
+   size_t n = host_uart_tx(b, sizeof(b));
+   LinkReply r = {0, 0, 0xFF};
+
+   if (n != LINK_REPLY_SIZE || !link_parse_reply(b, n, &r))
+      r.status = 0xFF;
+   return r;
+}
+
+// tramas cortas en su propio buffer: no pisan la que este en frame
+static LinkReply cmd_u32(uint8_t op, uint8_t ch, uint32_t v) {
+   uint8_t f[16], p[4];
+
+   link_put_u32(p, v);
+   send(f, link_frame(f, op, ch, p, 4));
+   return reply();
+}
+
+static LinkReply ping() {
+   uint8_t f[16];
+
+   send(f, link_frame(f, DdsLink::OP_PING, 0, 0, 0));
+   return reply();
+}
+
+static void test_basic() {
+   LinkReply r;
+
+   r = ping();
+   CHECK(r.status == DdsLink::ST_OK && r.op == DdsLink::OP_PING);
+   r = cmd_u32(DdsLink::OP_SET_FCW, 1, 0x01234567);
+   CHECK(r.status == DdsLink::ST_OK && r.ch == 1);
+   CHECK(host_dds_active(S6_DDS_AWG1, DdsAwgCore::FCW_REG) == 0x01234567);
+   r = cmd_u32(DdsLink::OP_SET_FCW, 2, 0x01234567);
+   CHECK(r.status == DdsLink::ST_BAD_CH);
+}
+
+// CRC erroneo: respuesta BAD_CRC y el canal no cambia
+static void test_bad_crc() {
+   uint8_t p[4];
+   uint32_t bad = link.get_frames_bad();
+   size_t n;
+
+   cmd_u32(DdsLink::OP_SET_FCW, 0, 0x00100000);
+   link_put_u32(p, 0x00200000);
+   n = link_frame(frame, DdsLink::OP_SET_FCW, 0, p, 4);
+   frame[n - 1] ^= 0x01;
+   send(frame, n);
+   CHECK(reply().status == DdsLink::ST_BAD_CRC);
+   CHECK(host_dds_active(S5_DDS_AWG, DdsAwgCore::FCW_REG) == 0x00100000);
+   CHECK(link.get_frames_bad() == bad + 1);
+}
+
+// LEN no valido: la trama se consume entera y la siguiente se atiende
+static void test_bad_len() {
+   uint8_t p[100];
+
+   memset(p, 0x55, sizeof(p));
+   send(frame, link_frame(frame, DdsLink::OP_SET_FCW, 0, p, 3));
+   CHECK(reply().status == DdsLink::ST_BAD_LEN);
+   send(frame, link_frame(frame, DdsLink::OP_PING, 0, p, DdsLink::MAX_PAYLOAD + 1));
+   CHECK(reply().status == DdsLink::ST_BAD_LEN);
+   send(frame, link_frame(frame, DdsLink::OP_AWG_LOAD, 0, p, 10));
+   CHECK(reply().status == DdsLink::ST_BAD_LEN);
+   CHECK(ping().status == DdsLink::ST_OK);
+}
+
+// trama cortada: tras LINK_TIMEOUT_MS sin bytes se busca un SOF nuevo
+static void test_timeout_resync() {
+   uint32_t bad = link.get_frames_bad();
+   size_t n;
+
+   n = link_frame(frame, DdsLink::OP_SET_FCW, 0, payload, 4);
+   send(frame, n - 3);
+   CHECK(reply().status == 0xFF);   // sin respuesta todavia
+   host_advance(TIMEOUT_TICKS);
+   CHECK(ping().status == DdsLink::ST_OK);
+   CHECK(link.get_frames_bad() == bad + 1);
+}
+
+// OP_BATCH: un solo COMMIT con todo, o nada si un sub-op no es valido
+static void test_batch() {
+   uint8_t p[DdsLink::MAX_PAYLOAD];
+   size_t len;
+   int commits;
+   LinkReply r;
+
+   cmd_u32(DdsLink::OP_SET_FCW, 0, 0x00100000);
+   len = link_batch_add(p, 0, DdsLink::OP_SET_FCW, 0x00300000);
+   len = link_batch_add(p, len, DdsLink::OP_SET_POW, 0x40000000);
+   len = link_batch_add(p, len, DdsLink::OP_ENABLE, 1);
+   commits = host_dds_commits(S5_DDS_AWG);
+   send(frame, link_frame(frame, DdsLink::OP_BATCH, 0, p, len));
+   r = reply();
+   CHECK(r.status == DdsLink::ST_OK && r.op == DdsLink::OP_BATCH);
+   CHECK(host_dds_commits(S5_DDS_AWG) == commits + 1);
+   CHECK(host_dds_active(S5_DDS_AWG, DdsAwgCore::FCW_REG) == 0x00300000);
+   CHECK(host_dds_active(S5_DDS_AWG, DdsAwgCore::POW_REG) == 0x40000000);
+   CHECK(host_dds_active(S5_DDS_AWG, DdsAwgCore::CTRL_REG) & 1);
+
+   // el ultimo registro no es valido: no se aplica ninguno
+   len = link_batch_add(p, 0, DdsLink::OP_SET_FCW, 0x00500000);
+   len = link_batch_add(p, len, DdsLink::OP_PING, 0);
+   commits = host_dds_commits(S5_DDS_AWG);
+   send(frame, link_frame(frame, DdsLink::OP_BATCH, 0, p, len));
+   CHECK(reply().status == DdsLink::ST_BAD_OP);
+   CHECK(host_dds_commits(S5_DDS_AWG) == commits);
+   CHECK(host_dds_active(S5_DDS_AWG, DdsAwgCore::FCW_REG) == 0x00300000);
+
+   send(frame, link_frame(frame, DdsLink::OP_BATCH, 0, p, 4));
+   CHECK(reply().status == DdsLink::ST_BAD_LEN);
+}
+
+// OP_AWG_LOAD: conmuta al banco nuevo solo con la tabla completa y sana
+static void test_awg_load() {
+   size_t len, n;
+   int play;
+
+   len = link_awg_payload(payload, AWG_TRIANGLE.sample, N);
+   n = link_frame(frame, DdsLink::OP_AWG_LOAD, 0, payload, len);
+   play = host_dds_play_bank(S5_DDS_AWG);
+   send(frame, n);
+   CHECK(reply().status == DdsLink::ST_OK);
+   CHECK(host_dds_play_bank(S5_DDS_AWG) != play);
+   play = host_dds_play_bank(S5_DDS_AWG);
+   CHECK(memcmp(host_dds_ram(S5_DDS_AWG, play), AWG_TRIANGLE.sample, sizeof(AWG_TRIANGLE.sample)) == 0);
+
+   // cortada a mitad: sin respuesta, el banco no cambia
+   len = link_awg_payload(payload, AWG_SAWTOOTH.sample, N);
+   n = link_frame(frame, DdsLink::OP_AWG_LOAD, 0, payload, len);
+   send(frame, n / 2);
+   host_advance(TIMEOUT_TICKS);
+   CHECK(ping().status == DdsLink::ST_OK);
+   CHECK(host_dds_play_bank(S5_DDS_AWG) == play);
+
+   // CRC de trama erroneo: BAD_CRC y el banco no cambia
+   frame[n / 2] ^= 0x01;
+   send(frame, n);
+   CHECK(reply().status == DdsLink::ST_BAD_CRC);
+   CHECK(host_dds_play_bank(S5_DDS_AWG) == play);
+   CHECK(memcmp(host_dds_ram(S5_DDS_AWG, play), AWG_TRIANGLE.sample, sizeof(AWG_TRIANGLE.sample)) == 0);
+
+   // el enlace sigue sano: la misma tabla intacta entra bien
+   frame[n / 2] ^= 0x01;
+   send(frame, n);
+   CHECK(reply().status == DdsLink::ST_OK);
+   CHECK(host_dds_play_bank(S5_DDS_AWG) != play);
+}
+
+int main() {
+   test_basic();
+   test_bad_crc();
+   test_bad_len();
+   test_timeout_resync();
+   test_batch();
+   test_awg_load();
+   return test_end("dds_link");
+}
@@ -0,0 +1,83 @@
+#include "test.h"
+#include "host_bus.h"
+#include "dds_multi_core.h"
+
+/**********************************************************************
+ * COMMIT armado (Sync Wait) sobre el modelo dds: un SYNC que no llega
+ * (o que se escribe en el canal esclavo) no bloquea el MCS; las esperas
+ * vencen en COMMIT_TIMEOUT_US y los cambios se aplican con el siguiente
+ * SYNC del maestro
+ **********************************************************************/
+static const uint64_t TIMEOUT_TICKS = (uint64_t) DdsAwgCore::COMMIT_TIMEOUT_US * SYS_CLK_FREQ;
+
+DdsAwgCore dds0(get_slot_addr(BRIDGE_BASE, S5_DDS_AWG));
+DdsAwgCore dds1(get_slot_addr(BRIDGE_BASE, S6_DDS_AWG1));
+DdsAwgCore *const chan[2] = {&dds0, &dds1};
+DdsMultiCore<2> iq(chan);
+
+static uint32_t fcw_act(int slot) {
+   return host_dds_active(slot, DdsAwgCore::FCW_REG);
+}
+
+// SYNC escrito en el esclavo: el COMMIT sigue armado
+static void test_sync_on_slave() {
+   uint64_t t0;
+
+   dds1.begin();
+   dds1.set_fcw(0x1000);
+   CHECK(dds1.commit_on_sync(false));
+   dds1.sync();
+   CHECK(!dds1.update_applied());
+   CHECK(fcw_act(S6_DDS_AWG1) == 0);
+
+   // setter y commit() del canal armado: vencen, no bloquean
+   t0 = host_tick();
+   CHECK(!dds1.set_fcw(0x2000));
+   CHECK(host_tick() - t0 >= TIMEOUT_TICKS);
+   CHECK(!dds1.commit());
+   CHECK(!dds1.commit_on_sync(false));
+   CHECK(!dds1.wait_applied());
+   CHECK(fcw_act(S6_DDS_AWG1) == 0);
+
+   // el SYNC del maestro aplica lo armado; el FCW posterior se queda en
+   // la sombra hasta el siguiente COMMIT
+   dds0.sync();
+   CHECK(dds1.update_applied());
+   CHECK(fcw_act(S6_DDS_AWG1) == 0x1000);
+   CHECK(dds1.commit());
+   CHECK(fcw_act(S6_DDS_AWG1) == 0x2000);
+   // Sync Wait se auto-borra: el setter ya no se arma
+   CHECK(dds1.set_fcw(0x3000));
+   CHECK(dds1.update_applied() && fcw_act(S6_DDS_AWG1) == 0x3000);
+}
+
+// un canal que quedo armado sin SYNC hace fallar commit()/restart()
+static void test_multi_missed_sync() {
+   dds1.begin();
+   dds1.set_fcw(0x4000);
+   CHECK(dds1.commit_on_sync(false));
+
+   iq.begin();
+   iq.channel(0)->set_fcw(0x5000);
+   iq.channel(1)->set_fcw(0x5000);
+   CHECK(!iq.restart());
+   // el SYNC se envia igualmente: nada queda armado
+   CHECK(iq.wait_applied());
+   CHECK(fcw_act(S5_DDS_AWG) == 0x5000);
+   CHECK(fcw_act(S6_DDS_AWG1) == 0x4000);
+
+   // los cambios siguen en la sombra del canal 1 y el reintento aplica
+   CHECK(iq.restart());
+   CHECK(iq.wait_applied() && iq.applied());
+   CHECK(fcw_act(S5_DDS_AWG) == 0x5000 && fcw_act(S6_DDS_AWG1) == 0x5000);
+   CHECK(iq.enable(true));
+   CHECK(iq.wait_applied());
+   CHECK((host_dds_active(S5_DDS_AWG, DdsAwgCore::CTRL_REG) & 1)
+      && (host_dds_active(S6_DDS_AWG1, DdsAwgCore::CTRL_REG) & 1));
+}
+
+int main() {
+   test_sync_on_slave();
+   test_multi_missed_sync();
+   return test_end("dds_sync");
+}
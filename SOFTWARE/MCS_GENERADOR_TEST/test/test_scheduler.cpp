@@ -0,0 +1,120 @@
+#include "test.h"
+#include "host_bus.h"
+#include "scheduler.h"
+
+/**********************************************************************
+ * Scheduler sobre el timer simulado: orden por plazo, periodicas sin
+ * deriva y reutilizacion de un hueco desde la propia tarea (las
+ * estadisticas de la tarea ejecutada no deben caer en la nueva)
+ **********************************************************************/
+static const uint32_t MS = 1000 * SYS_CLK_FREQ;   // ticks
+
+static Scheduler sched;
+static int order[8];
+static int order_n = 0;
+static int chained_id = -1;
+
+static void mark(void *arg) {
+   order[order_n++] = (int) (intptr_t) arg;
+}
+
+// un solo disparo que programa otro: reutiliza su propio hueco
+static void chain(void *arg) {
+   (void) arg;
+   chained_id = sched.add_oneshot("chained", mark, (void *) 9, 5000);
+}
+
+// periodica que se cancela y se vuelve a dar de alta en el mismo hueco
+static int self_id = -1;
+
+static void readd(void *arg) {
+   (void) arg;
+   sched.cancel(self_id);
+   self_id = sched.add_periodic("readd", mark, (void *) 7, 1000, 1000);
+}
+
+static void test_order() {
+   int a, b;
+
+   order_n = 0;
+   a = sched.add_oneshot("b", mark, (void *) 2, 2000);
+   b = sched.add_oneshot("a", mark, (void *) 1, 1000);
+   host_advance(3 * MS);
+   CHECK(sched.run() == 2);
+   CHECK(order_n == 2 && order[0] == 1 && order[1] == 2);
+   CHECK(sched.get_stats(a)->runs == 1 && sched.get_stats(b)->runs == 1);
+   CHECK(sched.idle_ticks() == -1);
+}
+
+static void test_periodic() {
+   const Scheduler::Stats *s;
+   int id, i;
+
+   id = sched.add_periodic("p", mark, (void *) 3, 1000, 1000);
+   for (i = 0; i < 5; i++) {
+      host_advance(MS);
+      sched.run();
+   }
+   s = sched.get_stats(id);
+   CHECK(s->runs == 5 && s->overruns == 0);
+   // 3.5 periodos sin llamar a run(): una ejecucion y plazos saltados
+   host_advance(3 * MS + MS / 2);
+   CHECK(sched.run() == 1);
+   CHECK(s->runs == 6 && s->overruns == 2);
+   sched.cancel(id);
+}
+
+static void test_slot_reuse() {
+   const Scheduler::Stats *s;
+   int id;
+
+   id = sched.add_oneshot("chain", chain, 0, 1000);
+   host_advance(2 * MS);
+   CHECK(sched.run() == 1);
+   CHECK(chained_id == id);
+   s = sched.get_stats(chained_id);
+   CHECK(s->runs == 0 && s->rt_max == 0 && s->late_max == 0 && s->rt_sum == 0);
+   host_advance(6 * MS);
+   order_n = 0;
+   CHECK(sched.run() == 1 && order_n == 1 && order[0] == 9);
+   CHECK(s->runs == 1);
+
+   self_id = sched.add_periodic("readd", readd, 0, 1000, 1000);
+   id = self_id;
+   host_advance(2 * MS);
+   CHECK(sched.run() == 1);
+   CHECK(self_id == id);
+   CHECK(sched.get_stats(self_id)->runs == 0);
+   sched.cancel(self_id);
+}
+
+// periodos y retardos de mas de 2^31 ticks se rechazan (no se truncan)
+static void test_limits() {
+   uint32_t max = Scheduler::MAX_DELAY_US;
+   int id;
+
+   CHECK(sched.add_periodic("p20s", mark, 0, 20000000, 0) == -1);
+   CHECK(sched.add_periodic("ph20s", mark, 0, 1000, 20000000) == -1);
+   CHECK(sched.add_oneshot("o20s", mark, 0, 20000000) == -1);
+   CHECK(sched.add_periodic("pmax", mark, 0, max + 1, 0) == -1);
+   CHECK(sched.add_oneshot("omax", mark, 0, 0xFFFFFFFF) == -1);
+
+   // en el limite: no vence antes de tiempo y si despues
+   id = sched.add_periodic("max", mark, (void *) 5, max, max);
+   CHECK(id >= 0);
+   order_n = 0;
+   host_advance((uint64_t) max * SYS_CLK_FREQ - MS);
+   CHECK(sched.run() == 0 && order_n == 0);
+   host_advance(2 * MS);
+   CHECK(sched.run() == 1 && order_n == 1 && order[0] == 5);
+   CHECK(sched.idle_ticks() > 0);
+   sched.cancel(id);
+}
+
+int main() {
+   test_order();
+   test_periodic();
+   test_slot_reuse();
+   test_limits();
+   return test_end("scheduler");
+}
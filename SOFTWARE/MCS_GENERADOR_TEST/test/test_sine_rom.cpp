@@ -0,0 +1,101 @@
+#include <math.h>
+#include "test.h"
+#include "dds_awg_core.h"
+
+/**********************************************************************
+ * Modelo de referencia de la ROM senoidal plegada (dds_awg_core.vhd)
+ *  - rom_model() repite init_sin_rom (1/4 de onda, muestreada en i+0.5)
+ *  - folded() repite el plegado de gen_lane: indice invertido en los
+ *    cuadrantes 1 y 3, amplitud negada en el semiciclo negativo
+ *  - ideal() es el seno completo sin plegar, desplazado medio paso de
+ *    fase y centrado en 2^(DAC_WIDTH-1) - 0.5
+ * Si cambia init_sin_rom o el plegado, este modelo debe cambiar igual.
+ **********************************************************************/
+static const int SINE_WIDTH = DdsAwgCore::SINE_PHASE_WIDTH;
+static const int N = DdsAwgCore::SINE_TABLE_SIZE;
+static const int ROM_DEPTH = N / 4;
+static const int AMP_WIDTH = DdsAwgCore::DAC_WIDTH - 1;
+static const int AMP_MAX = (1 << AMP_WIDTH) - 1;
+static const int MID = 1 << AMP_WIDTH;                   // 8192
+static const double HALF_SCALE = (double) MID - 0.5;     // 8191.5
+
+static int rom[ROM_DEPTH];
+
+// init_sin_rom: round() de VHDL redondea los empates lejos de 0, igual que lround()
+static void rom_model() {
+   for (int i = 0; i < ROM_DEPTH; i++) {
+      double y = sin((i + 0.5) * M_PI / (2.0 * ROM_DEPTH));
+      long val = lround(y * HALF_SCALE - 0.5);
+      if (val > AMP_MAX)
+         val = AMP_MAX;
+      if (val < 0)
+         val = 0;
+      rom[i] = (int) val;
+   }
+}
+
+// sine_addr, sine_amp_raw, sine_neg_raw y sine_val de gen_lane
+static int folded(int phase) {
+   int idx = phase & (ROM_DEPTH - 1);
+   int amp;
+
+   if (phase & (N / 4))                    // cuadrantes 1 y 3
+      idx = ~idx & (ROM_DEPTH - 1);
+   amp = rom[idx];
+   if ((phase & (N / 2)) == 0)             // semiciclo positivo
+      return MID | amp;
+   return ~amp & AMP_MAX;
+}
+
+static int ideal(int phase) {
+   return (int) lround(HALF_SCALE + HALF_SCALE * sin(2.0 * M_PI * (phase + 0.5) / N));
+}
+
+// fase del seno de un carril: solo se suman los SINE_WIDTH MSB
+static int sine_phase(uint32_t acc, uint32_t pow) {
+   return (int) (((acc >> (32 - SINE_WIDTH)) + (pow >> (32 - SINE_WIDTH))) & (N - 1));
+}
+
+int main() {
+   int err_max = 0;
+
+   rom_model();
+   // la ROM plegada reproduce el seno completo muestra a muestra
+   for (int p = 0; p < N; p++) {
+      CHECK(folded(p) == ideal(p));
+      CHECK(folded(p) >= 0 && folded(p) <= DdsAwgCore::DAC_MAX);
+   }
+   // error frente al seno real: como mucho medio LSB
+   for (int p = 0; p < N; p++) {
+      double y = HALF_SCALE + HALF_SCALE * sin(2.0 * M_PI * (p + 0.5) / N);
+      int e = (int) lround(fabs(folded(p) - y) * 1000);
+      if (e > err_max)
+         err_max = e;
+   }
+   CHECK(err_max <= 500);
+   // medio paso de fase: espejo exacto en el cuarto y antisimetria
+   // respecto a mid-scale - 0.5 (sin el desplazamiento ninguna se cumple)
+   for (int p = 0; p < N / 2; p++)
+      CHECK(folded(p) == folded(N / 2 - 1 - p));
+   for (int p = 0; p < N; p++)
+      CHECK(folded(p) + folded(N - 1 - p) == DdsAwgCore::DAC_MAX);
+   CHECK(folded(0) == MID + rom[0] && rom[0] > 0);
+   CHECK(folded(N / 4 - 1) == MID + AMP_MAX && folded(N / 4) == MID + AMP_MAX);
+   // los bits bajos de fase y POW no llegan a sumarse (sin acarreo)
+   CHECK(sine_phase(0x000FFFFF, 0x00000001) == 0);
+   CHECK(sine_phase(0x00100000, 0xFFF00000) == 0);
+   // salida del acumulador con distintos FCW/POW, muestra a muestra
+   const uint32_t fcw[] = { 0x00100000, 0x0123ABCD, 0x7FFFFFFF, 0x00000001 };
+   const uint32_t pow[] = { 0, 0x40000000, 0xC0080000, 0x000FFFFF };
+   for (int f = 0; f < 4; f++) {
+      for (int w = 0; w < 4; w++) {
+         uint32_t acc = 0x000FFFFF * f;
+         for (int n = 0; n < 5000; n++) {
+            int p = sine_phase(acc, pow[w]);
+            CHECK(folded(p) == ideal(p));
+            acc += fcw[f];
+         }
+      }
+   }
+   return test_end("sine_rom");
+}
@@ -0,0 +1,82 @@
+#include <string.h>
+#include "test.h"
+#include "host_bus.h"
+#include "trace_decode.h"
+#include "trace.h"
+#include "uart_core.h"
+
+/**********************************************************************
+ * Volcado binario del trace: trace_dump_bin() por la uart simulada y
+ * trace_decode() en el host deben dar los mismos registros, con los
+ * deltas correctos aunque el tick de 32 bits de la vuelta
+ **********************************************************************/
+UartCore uart(get_slot_addr(BRIDGE_BASE, S3_UART));
+
+static uint8_t dump[65536];
+static TraceEvent ev[TRACE_SIZE + 1];
+
+static int dump_decode(TraceInfo *info) {
+   size_t n;
+
+   host_uart_tx(dump, sizeof(dump));   // descarta lo anterior
+   trace_dump_bin(&uart);
+   n = host_uart_tx(dump, sizeof(dump));
+   return trace_decode(dump, n, info, ev, TRACE_SIZE + 1);
+}
+
+static void test_timeline() {
+   TraceInfo info;
+   int n;
+
+   trace_clear();
+   trace(TRACE_APP, "arranque", 1, -2);
+   host_advance(1000 * SYS_CLK_FREQ);            // 1 ms
+   trace(TRACE_LINK, "link frame", 0x10, 0);
+   host_advance(0xFFFFFF00ULL);                  // casi una vuelta del tick32
+   trace(TRACE_AWG, "wave load", 3, 1);
+   n = dump_decode(&info);
+   CHECK(n == 3);
+   CHECK(info.count == 3 && info.lost == 0 && info.clk_mhz == SYS_CLK_FREQ);
+   CHECK(strcmp(ev[0].msg, "arranque") == 0 && ev[0].a1 == 1 && ev[0].a2 == -2);
+   CHECK(strcmp(ev[1].msg, "link frame") == 0 && ev[1].a1 == 0x10);
+   CHECK(strcmp(ev[2].msg, "wave load") == 0 && ev[2].a1 == 3 && ev[2].a2 == 1);
+   // cada trace_put() cuesta un acceso al bus simulado (now_tick32)
+   CHECK(ev[1].delta >= 1000 * SYS_CLK_FREQ && ev[1].delta < 1000 * SYS_CLK_FREQ + 16);
+   CHECK(ev[2].tick >= 0xFFFFFF00ULL + 1000 * SYS_CLK_FREQ);
+   CHECK(ev[2].tick == (uint64_t) ev[1].delta + ev[2].delta);
+}
+
+// ring lleno: quedan los TRACE_SIZE mas nuevos y se cuentan los perdidos
+static void test_overflow() {
+   TraceInfo info;
+   int i, n;
+
+   trace_clear();
+   for (i = 0; i < TRACE_SIZE + 5; i++)
+      trace(TRACE_APP, "evento", i, 0);
+   n = dump_decode(&info);
+   CHECK(n == TRACE_SIZE && info.lost == 5);
+   CHECK(ev[0].a1 == 5 && ev[n - 1].a1 == TRACE_SIZE + 4);
+}
+
+// cabecera buscada detras de texto; volcado cortado rechazado
+static void test_framing() {
+   TraceInfo info;
+   size_t n;
+
+   trace_clear();
+   trace(TRACE_APP, "evento", 7, 0);
+   host_uart_tx(dump, sizeof(dump));
+   uart.disp("texto previo\n\r");
+   trace_dump_bin(&uart);
+   n = host_uart_tx(dump, sizeof(dump));
+   CHECK(trace_decode(dump, n, &info, ev, 4) == 1 && ev[0].a1 == 7);
+   CHECK(trace_decode(dump, n - 1, &info, ev, 4) == -1);
+}
+
+int main() {
+   test_timeline();
+   test_overflow();
+   test_framing();
+   return test_end("trace");
+}
@@ -0,0 +1,175 @@
+#include <string.h>
+#include "test.h"
+#include "host_bus.h"
+#include "spi_core.h"
+#include "sim_flash.h"
+#include "wave_store.h"
+#include "awg_waveforms.h"
+
+/**********************************************************************
+ * WaveStore sobre SimFlash (array en RAM, ss 0) y sobre SpiFlash contra
+ * una flash del bus simulado (ss 1): empaquetado de 14 bits, add/mount/find/load, CRC de la
+ * carga, biblioteca llena, JEDEC ID y esperas acotadas de una flash que
+ * no termina nunca
+ **********************************************************************/
+static const uint32_t SIM_SIZE = 0x10000;   // 64 KB: 34 tablas
+static uint8_t sim_mem[SIM_SIZE];
+static const uint32_t BUS_SIZE = 0x10000;
+static uint8_t bus_mem[BUS_SIZE];
+
+static SpiCore spi(get_slot_addr(BRIDGE_BASE, S4_SPI));
+static DdsAwgCore dds(get_slot_addr(BRIDGE_BASE, S5_DDS_AWG));
+
+static bool ram_equal(int bank, const uint16_t *table) {
+   return memcmp(host_dds_ram(S5_DDS_AWG, bank), table,
+                 DdsAwgCore::TABLE_SIZE * sizeof(uint16_t)) == 0;
+}
+
+static void test_pack() {
+   uint16_t s[4], r[4];
+   uint8_t b[7];
+   int v, i, err = 0;
+
+   for (v = 0; v <= DdsAwgCore::DAC_MAX; v++) {
+      for (i = 0; i < 4; i++)
+         s[i] = (v + i * 0x1357) & DdsAwgCore::DAC_MAX;
+      WaveStore::pack4(s, b);
+      WaveStore::unpack4(b, r);
+      if (memcmp(s, r, sizeof(s)) != 0)
+         err++;
+   }
+   CHECK(err == 0);
+   // extremos: todo ceros y todo unos llenan los 7 bytes
+   for (i = 0; i < 4; i++)
+      s[i] = DdsAwgCore::DAC_MAX;
+   WaveStore::pack4(s, b);
+   CHECK(b[0] == 0xFF && b[6] == 0xFF);
+   for (i = 0; i < 4; i++)
+      s[i] = 0;
+   WaveStore::pack4(s, b);
+   CHECK(b[0] == 0x00 && b[6] == 0x00);
+}
+
+static void test_sim_library() {
+   SimFlash sim(sim_mem, SIM_SIZE);
+   WaveStore ws(&sim, SIM_SIZE);
+   WaveEntry e;
+
+   memset(sim_mem, 0xFF, sizeof(sim_mem));
+   CHECK(SpiFlash::known_id(sim.read_id()));
+   CHECK(!ws.mount());
+   CHECK(ws.count() == 0);
+   CHECK(ws.add("x", AWG_TRIANGLE.sample) == -1);   // sin montar
+   CHECK(ws.format());
+   CHECK(ws.count() == 0);
+   CHECK(ws.add("square50", AWG_SQUARE_50.sample) == 0);
+   CHECK(ws.add("triangle", AWG_TRIANGLE.sample) == 1);
+   CHECK(ws.add("un_nombre_demasiado_largo_para_el_directorio",
+                AWG_SAWTOOTH.sample) == 2);
+   CHECK(ws.count() == 3);
+   CHECK(ws.find("triangle") == 1);
+   CHECK(ws.find("square25") == -1);
+   CHECK(ws.get_entry(2, &e));
+   CHECK(strlen(e.name) == WaveStore::NAME_LEN - 1);
+   CHECK(ws.find(e.name) == 2);
+   CHECK(!ws.get_entry(3, &e));
+
+   // otra instancia sobre la misma memoria ve las mismas entradas
+   WaveStore ws2(&sim, SIM_SIZE);
+   CHECK(ws2.mount());
+   CHECK(ws2.count() == 3);
+   CHECK(ws2.find("square50") == 0 && ws2.find("triangle") == 1);
+   CHECK(ws2.add("square75", AWG_SQUARE_75.sample) == 3);
+}
+
+static void test_sim_load() {
+   SimFlash sim(sim_mem, SIM_SIZE);
+   WaveStore ws(&sim, SIM_SIZE);
+   WaveEntry e;
+   int play;
+
+   CHECK(ws.mount() && ws.count() == 4);
+   play = host_dds_play_bank(S5_DDS_AWG);
+   CHECK(ws.load(ws.find("triangle"), &dds, false));
+   CHECK(ram_equal(dds.get_write_bank(), AWG_TRIANGLE.sample));
+   CHECK(host_dds_play_bank(S5_DDS_AWG) == play);
+   CHECK(ws.load(ws.find("square75"), &dds, true));
+   CHECK(ram_equal(dds.get_write_bank(), AWG_SQUARE_75.sample));
+   CHECK(host_dds_play_bank(S5_DDS_AWG) == dds.get_write_bank());
+   CHECK(!ws.load(-1, &dds, true) && !ws.load(4, &dds, true));
+
+   // un byte de datos corrupto: falla el CRC y no se conmuta
+   CHECK(ws.get_entry(ws.find("square50"), &e));
+   sim_mem[e.addr + 100] ^= 0x01;
+   play = host_dds_play_bank(S5_DDS_AWG);
+   CHECK(!ws.load(ws.find("square50"), &dds, true));
+   CHECK(host_dds_play_bank(S5_DDS_AWG) == play);
+   sim_mem[e.addr + 100] ^= 0x01;
+   CHECK(ws.load(ws.find("square50"), &dds, true));
+}
+
+static void test_sim_full() {
+   SimFlash sim(sim_mem, SIM_SIZE);
+   WaveStore ws(&sim, SIM_SIZE);
+   int max = (SIM_SIZE - WaveStore::DATA_START) / WaveStore::PACKED_SIZE;
+   int i, last = 0;
+
+   CHECK(ws.format());
+   for (i = 0; i < max + 2; i++) {
+      last = ws.add("w", AWG_SAWTOOTH.sample);
+      if (last < 0)
+         break;
+   }
+   CHECK(i == max && last == -1);
+   CHECK(ws.count() == max);
+   CHECK(ws.load(max - 1, &dds, false));
+   CHECK(ram_equal(dds.get_write_bank(), AWG_SAWTOOTH.sample));
+}
+
+static void test_spi_flash() {
+   SpiFlash flash(&spi, 1);
+   WaveStore ws(&flash, BUS_SIZE);
+   uint8_t b[4] = {1, 2, 3, 4};
+   uint64_t t0;
+
+   spi.set_mode(0, 0);
+   spi.set_width(8);
+   // sin dispositivo MISO lee unos: ID desconocido
+   host_spi_detach(1);
+   CHECK(flash.read_id() == 0xFFFFFF);
+   CHECK(!SpiFlash::known_id(flash.read_id()));
+   CHECK(!SpiFlash::known_id(0x000000));
+
+   // flash que no termina nunca: las esperas vencen y se devuelve error
+   memset(bus_mem, 0xFF, sizeof(bus_mem));
+   host_flash_attach(1, bus_mem, BUS_SIZE, SpiFlash::JEDEC_N25Q256, -1);
+   CHECK(SpiFlash::known_id(flash.read_id()));
+   t0 = host_tick();
+   CHECK(!flash.program(0, b, sizeof(b)));
+   CHECK(host_tick() - t0 >= (uint64_t) SpiFlash::PROGRAM_TIMEOUT_US * SYS_CLK_FREQ);
+   t0 = host_tick();
+   CHECK(!flash.erase_sector(0));
+   CHECK(host_tick() - t0 >= (uint64_t) SpiFlash::ERASE_TIMEOUT_US * SYS_CLK_FREQ);
+   CHECK(!ws.format());
+   CHECK(!ws.mount());
+
+   // flash correcta: la biblioteca completa sobre el bus
+   memset(bus_mem, 0xFF, sizeof(bus_mem));
+   host_flash_attach(1, bus_mem, BUS_SIZE, SpiFlash::JEDEC_N25Q128, 4);
+   CHECK(ws.format());
+   CHECK(ws.add("triangle", AWG_TRIANGLE.sample) == 0);
+   CHECK(ws.add("square25", AWG_SQUARE_25.sample) == 1);
+   CHECK(ws.mount() && ws.count() == 2);
+   CHECK(ws.load(ws.find("square25"), &dds, true));
+   CHECK(ram_equal(dds.get_write_bank(), AWG_SQUARE_25.sample));
+   CHECK(host_dds_play_bank(S5_DDS_AWG) == dds.get_write_bank());
+}
+
+int main() {
+   test_pack();
+   test_sim_library();
+   test_sim_load();
+   test_sim_full();
+   test_spi_flash();
+   return test_end("wave_store");
+}
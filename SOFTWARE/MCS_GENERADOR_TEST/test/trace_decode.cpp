@@ -0,0 +1,57 @@
+#include <string.h>
+#include "trace_decode.h"
+
+static uint32_t get_u32(const uint8_t *p) {
+   return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16)
+          | ((uint32_t) p[3] << 24);
+}
+
+int trace_decode(const uint8_t *p, size_t n, TraceInfo *info, TraceEvent *ev, int max) {
+   const size_t HDR = 16, REC = 13;
+   uint32_t tick, prev = 0;
+   uint64_t t = 0;
+   size_t pos, len;
+   int i;
+
+   // el volcado puede venir detras de otra salida de la uart
+   for (pos = 0; pos + HDR <= n && memcmp(p + pos, "TRC1", 4) != 0; pos++) {
+   }
+   if (pos + HDR > n)
+      return -1;
+   p += pos;
+   n -= pos;
+   info->clk_mhz = get_u32(p + 4);
+   info->count = get_u32(p + 8);
+   info->lost = get_u32(p + 12);
+   if (info->clk_mhz == 0)
+      return -1;
+   pos = HDR;
+   for (i = 0; i < (int) info->count && i < max; i++) {
+      if (pos + REC > n)
+         return -1;
+      tick = get_u32(p + pos);
+      len = p[pos + 12];
+      if (pos + REC + len > n)
+         return -1;
+      // resta modulo 2^32: el tick del firmware solo guarda 32 bits
+      ev[i].delta = (i == 0) ? 0 : tick - prev;
+      t += ev[i].delta;
+      ev[i].tick = t;
+      ev[i].a1 = (int32_t) get_u32(p + pos + 4);
+      ev[i].a2 = (int32_t) get_u32(p + pos + 8);
+      memcpy(ev[i].msg, p + pos + REC, len);
+      ev[i].msg[len] = '\0';
+      prev = tick;
+      pos += REC + len;
+   }
+   return i;
+}
+
+void trace_print(FILE *out, const TraceInfo *info, const TraceEvent *ev, int n) {
+   fprintf(out, "trace: %u registros, %u perdidos, %u MHz\n", (unsigned) info->count,
+           (unsigned) info->lost, (unsigned) info->clk_mhz);
+   for (int i = 0; i < n; i++)
+      fprintf(out, "%12.3f +%10.3f  %-20s 0x%08x 0x%08x\n",
+              (double) ev[i].tick / info->clk_mhz, (double) ev[i].delta / info->clk_mhz,
+              ev[i].msg, (unsigned) ev[i].a1, (unsigned) ev[i].a2);
+}
@@ -0,0 +1,56 @@
+#ifndef _TRACE_DECODE_H_INCLUDED
+#define _TRACE_DECODE_H_INCLUDED
+#include <stdio.h>
+#include <stddef.h>
+#include <inttypes.h>
+
+/**********************************************************************
+ * Decodificador en el host del volcado binario de trace_dump_bin()
+ * (formato en trace.h)
+ *  - trace_decode() busca la cabecera (el volcado puede ir detras de
+ *    otra salida de la uart) y separa los registros
+ *  - trace_print() los imprime como linea de tiempo: tiempo en us desde
+ *    el primer registro, delta con el anterior en us, msg, a1 y a2; los
+ *    ticks de 32 bits se desenrollan (deltas < 2^32 ciclos, 34 s)
+ *  - trace_decode_tool lo aplica a un fichero o a stdin:
+ *       trace_decode_tool volcado.bin
+ **********************************************************************/
+
+static const int TRACE_MSG_MAX = 256;
+
+struct TraceEvent {
+   uint64_t tick;        // ciclos desde el primer registro (desenrollado)
+   uint32_t delta;       // ciclos desde el registro anterior
+   int32_t a1;
+   int32_t a2;
+   char msg[TRACE_MSG_MAX];
+};
+
+struct TraceInfo {
+   uint32_t clk_mhz;     // SYS_CLK_FREQ del firmware
+   uint32_t count;       // registros en el volcado
+   uint32_t lost;        // registros sobrescritos antes del volcado
+};
+
+/**
+ * decodifica un volcado.
+ * @param p bytes recibidos
+ * @param n # bytes
+ * @param info cabecera
+ * @param ev destino de los registros
+ * @param max tamano de ev
+ * @return # registros decodificados, -1 si la cabecera no es valida o
+ *         el volcado esta incompleto
+ */
+int trace_decode(const uint8_t *p, size_t n, TraceInfo *info, TraceEvent *ev, int max);
+
+/**
+ * imprime la linea de tiempo.
+ * @param out fichero de salida
+ * @param info cabecera
+ * @param ev registros
+ * @param n # registros
+ */
+void trace_print(FILE *out, const TraceInfo *info, const TraceEvent *ev, int n);
+
+#endif  // _TRACE_DECODE_H_INCLUDED
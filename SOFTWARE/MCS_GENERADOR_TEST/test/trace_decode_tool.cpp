@@ -0,0 +1,29 @@
+#include <stdio.h>
+#include "trace_decode.h"
+
+/**********************************************************************
+ * Linea de tiempo de un volcado de trace_dump_bin() capturado de la
+ * uart (fichero o stdin)
+ **********************************************************************/
+static uint8_t dump[1 << 20];
+static TraceEvent ev[4096];
+
+int main(int argc, char **argv) {
+   FILE *in = stdin;
+   TraceInfo info;
+   size_t n;
+   int k;
+
+   if (argc > 1 && !(in = fopen(argv[1], "rb"))) {
+      perror(argv[1]);
+      return 1;
+   }
+   n = fread(dump, 1, sizeof(dump), in);
+   k = trace_decode(dump, n, &info, ev, (int) (sizeof(ev) / sizeof(ev[0])));
+   if (k < 0) {
+      fprintf(stderr, "volcado no valido o incompleto\n");
+      return 1;
+   }
+   trace_print(stdout, &info, ev, k);
+   return 0;
+}
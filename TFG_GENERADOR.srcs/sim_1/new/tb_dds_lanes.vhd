@@ -0,0 +1,355 @@
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+-- Banco de pruebas del datapath polifase de dds_awg_core
+--  - tres nucleos con la misma tasa de muestras: LANES = 1 con clk_f,
+--    LANES = 2 con clk_f/2 y LANES = 4 con clk_f/4
+--  - la salida de cada nucleo multicarril se serializa (carril 0 primero)
+--    en el dominio de clk_f y se compara muestra a muestra con la del
+--    nucleo de un carril; el retardo entre ambas se busca una vez
+--    (enganche) y despues debe mantenerse
+--  - fase 1: seno con FCW y POW arbitrarios
+--  - fase 2: AWG con un FCW cuyo periodo no es multiplo de 4 muestras y
+--    tres conmutaciones de banco; el wrap cae en carriles distintos y la
+--    salida debe seguir siendo identica a la de un carril
+-- Sin dependencias de VHDL-2008: termina al parar los relojes, p.ej.
+--    ghdl -a dds_awg_core.vhd tb_dds_lanes.vhd
+--    ghdl -e tb_dds_lanes
+--    ghdl -r tb_dds_lanes
+entity tb_dds_lanes is
+end tb_dds_lanes;
+
+architecture sim of tb_dds_lanes is
+
+    constant DAC_WIDTH  : integer := 14;
+    constant PHASE_WIDTH: integer := 10;
+    constant BANK_BITS  : integer := 2;
+    constant T_F        : time := 2 ns;   -- una muestra
+    constant T_BUS      : time := 10 ns;
+
+    -- enganche y comparacion
+    constant H          : integer := 128; -- retardos buscados (muestras)
+    constant D0         : integer := 64;  -- retardo fijo del nucleo multicarril
+    constant W_LOCK     : integer := 256; -- muestras para fijar el retardo
+
+    type int_array is array (natural range <>) of integer;
+    type sample_array is array (0 to 1) of integer;
+
+    signal done        : boolean := false;
+    signal clk_f       : std_logic := '0';
+    signal clk_bus     : std_logic := '0';
+    signal div         : unsigned(1 downto 0) := (others => '0');
+    signal clk2, clk4  : std_logic;
+    signal reset       : std_logic := '1';
+
+    -- bus comun a los tres nucleos
+    signal fcw         : unsigned(31 downto 0) := (others => '0');
+    signal pow         : unsigned(31 downto 0) := (others => '0');
+    signal enable      : std_logic := '0';
+    signal wave_sel    : std_logic := '0';
+    signal param_req   : std_logic := '0';
+    signal param_ack   : std_logic_vector(0 to 2);
+    signal ram_we      : std_logic := '0';
+    signal ram_bank    : unsigned(BANK_BITS-1 downto 0) := (others => '0');
+    signal ram_addr    : unsigned(PHASE_WIDTH-1 downto 0) := (others => '0');
+    signal ram_data    : std_logic_vector(DAC_WIDTH-1 downto 0) := (others => '0');
+    signal bank_sel    : unsigned(BANK_BITS-1 downto 0) := (others => '0');
+    signal bank_req    : std_logic := '0';
+    signal bank_ack    : std_logic_vector(0 to 2);
+
+    signal dac1        : std_logic_vector(DAC_WIDTH-1 downto 0);
+    signal dac2        : std_logic_vector(2*DAC_WIDTH-1 downto 0);
+    signal dac4        : std_logic_vector(4*DAC_WIDTH-1 downto 0);
+
+    -- flujos serializados en clk_f (1: referencia, ser(0): LANES=2, ser(1): LANES=4)
+    signal ref_s       : integer := 0;
+    signal ser         : sample_array := (others => 0);
+    signal ser_lane    : sample_array := (others => 0);  -- carril de la muestra
+
+    signal chk_en      : std_logic := '0';
+    signal locked      : std_logic_vector(0 to 1) := (others => '0');
+    signal n_ok        : int_array(0 to 1) := (others => 0);
+    signal n_err       : int_array(0 to 1) := (others => 0);
+    signal n_swap      : int_array(0 to 1) := (others => 0);   -- conmutaciones vistas
+    signal swap_off0   : int_array(0 to 1) := (others => 0);   -- ... fuera del carril 0
+
+    -- tablas AWG: A = 16*i + 1 (mod 16 = 1), B = 16383 - 16*i (mod 16 = 15)
+    function tab(bank : integer; i : integer) return integer is
+    begin
+        if bank = 0 then
+            return 16*i + 1;
+        end if;
+        return 2**DAC_WIDTH - 1 - 16*i;
+    end function;
+
+    function lane(word : std_logic_vector; k : integer) return integer is
+    begin
+        return to_integer(unsigned(word((k+1)*DAC_WIDTH-1 downto k*DAC_WIDTH)));
+    end function;
+
+begin
+
+    ------------------------------------------------------------------
+    -- Relojes: clk2 y clk4 suben en los flancos de clk_f (un delta mas
+    -- tarde), asi sus salidas son estables cuando se muestrean en clk_f
+    ------------------------------------------------------------------
+    clk_f   <= not clk_f after T_F / 2 when not done else '0';
+    clk_bus <= not clk_bus after T_BUS / 2 when not done else '0';
+
+    process(clk_f)
+    begin
+        if rising_edge(clk_f) then
+            div <= div + 1;
+        end if;
+    end process;
+
+    clk2 <= not div(0);
+    clk4 <= not div(1);
+
+    ------------------------------------------------------------------
+    -- Nucleos bajo prueba
+    ------------------------------------------------------------------
+    dut1 : entity work.dds_awg_core
+        generic map (PHASE_WIDTH => PHASE_WIDTH, DAC_WIDTH => DAC_WIDTH,
+                     BANK_BITS => BANK_BITS, LANES => 1)
+        port map (
+            clk => clk_f, reset => reset,
+            fcw => fcw, phase_offset => pow, enable => enable, wave_sel => wave_sel,
+            phase_rst => '0', sync_wait => '0', sync_pulse => '0',
+            param_req_tgl => param_req, param_ack_tgl => param_ack(0),
+            sweep_start => (others => '0'), sweep_stop => (others => '0'),
+            sweep_step => (others => '0'), sweep_dwell => (others => '0'),
+            sweep_ctrl => (others => '0'), sweep_active => open,
+            ram_clk => clk_bus, ram_we => ram_we, ram_bank_in => ram_bank,
+            ram_pair => '0', ram_addr_in => ram_addr, ram_data_in => ram_data,
+            ram_data2_in => ram_data, scan_addr => (others => '0'),
+            scan_even => open, scan_odd => open,
+            bank_sel => bank_sel, bank_req_tgl => bank_req, bank_ack_tgl => bank_ack(0),
+            dac_out => dac1);
+
+    dut2 : entity work.dds_awg_core
+        generic map (PHASE_WIDTH => PHASE_WIDTH, DAC_WIDTH => DAC_WIDTH,
+                     BANK_BITS => BANK_BITS, LANES => 2)
+        port map (
+            clk => clk2, reset => reset,
+            fcw => fcw, phase_offset => pow, enable => enable, wave_sel => wave_sel,
+            phase_rst => '0', sync_wait => '0', sync_pulse => '0',
+            param_req_tgl => param_req, param_ack_tgl => param_ack(1),
+            sweep_start => (others => '0'), sweep_stop => (others => '0'),
+            sweep_step => (others => '0'), sweep_dwell => (others => '0'),
+            sweep_ctrl => (others => '0'), sweep_active => open,
+            ram_clk => clk_bus, ram_we => ram_we, ram_bank_in => ram_bank,
+            ram_pair => '0', ram_addr_in => ram_addr, ram_data_in => ram_data,
+            ram_data2_in => ram_data, scan_addr => (others => '0'),
+            scan_even => open, scan_odd => open,
+            bank_sel => bank_sel, bank_req_tgl => bank_req, bank_ack_tgl => bank_ack(1),
+            dac_out => dac2);
+
+    dut4 : entity work.dds_awg_core
+        generic map (PHASE_WIDTH => PHASE_WIDTH, DAC_WIDTH => DAC_WIDTH,
+                     BANK_BITS => BANK_BITS, LANES => 4)
+        port map (
+            clk => clk4, reset => reset,
+            fcw => fcw, phase_offset => pow, enable => enable, wave_sel => wave_sel,
+            phase_rst => '0', sync_wait => '0', sync_pulse => '0',
+            param_req_tgl => param_req, param_ack_tgl => param_ack(2),
+            sweep_start => (others => '0'), sweep_stop => (others => '0'),
+            sweep_step => (others => '0'), sweep_dwell => (others => '0'),
+            sweep_ctrl => (others => '0'), sweep_active => open,
+            ram_clk => clk_bus, ram_we => ram_we, ram_bank_in => ram_bank,
+            ram_pair => '0', ram_addr_in => ram_addr, ram_data_in => ram_data,
+            ram_data2_in => ram_data, scan_addr => (others => '0'),
+            scan_even => open, scan_odd => open,
+            bank_sel => bank_sel, bank_req_tgl => bank_req, bank_ack_tgl => bank_ack(2),
+            dac_out => dac4);
+
+    ------------------------------------------------------------------
+    -- Serializador: en el flanco de clk_f en que sube clkN todavia se ve
+    -- la palabra anterior, que es estable desde el flanco siguiente al
+    -- de la subida anterior; el carril que toca coincide con div
+    ------------------------------------------------------------------
+    process(clk_f)
+    begin
+        if rising_edge(clk_f) then
+            ref_s       <= to_integer(unsigned(dac1));
+            ser(0)      <= lane(dac2, to_integer(div(0 downto 0)));
+            ser_lane(0) <= to_integer(div(0 downto 0));
+            ser(1)      <= lane(dac4, to_integer(div));
+            ser_lane(1) <= to_integer(div);
+        end if;
+    end process;
+
+    ------------------------------------------------------------------
+    -- Comparadores (uno por nucleo multicarril)
+    ------------------------------------------------------------------
+    gen_chk : for g in 0 to 1 generate
+        process(clk_f)
+            variable ref_h  : int_array(0 to H-1) := (others => 0);
+            variable ser_h  : int_array(0 to D0) := (others => 0);
+            variable cand   : std_logic_vector(0 to H-1);
+            variable n      : integer := 0;
+            variable d      : integer := 0;
+            variable cnt    : integer;
+            variable prev   : integer := 0;
+        begin
+            if rising_edge(clk_f) then
+                for i in H-1 downto 1 loop
+                    ref_h(i) := ref_h(i-1);
+                end loop;
+                ref_h(0) := ref_s;
+                for i in D0 downto 1 loop
+                    ser_h(i) := ser_h(i-1);
+                end loop;
+                ser_h(0) := ser(g);
+
+                -- conmutaciones de banco en el flujo multicarril (mod 16: 1 <-> 15)
+                if chk_en = '1' and wave_sel = '1' and
+                   (ser(g) mod 16 = 1 or ser(g) mod 16 = 15) and
+                   (prev mod 16 = 1 or prev mod 16 = 15) and ser(g) mod 16 /= prev mod 16 then
+                    n_swap(g) <= n_swap(g) + 1;
+                    if ser_lane(g) /= 0 then
+                        swap_off0(g) <= swap_off0(g) + 1;
+                    end if;
+                end if;
+                prev := ser(g);
+
+                if chk_en = '0' then
+                    locked(g) <= '0';
+                    cand := (others => '1');
+                    n := 0;
+                elsif locked(g) = '0' then
+                    -- retardos que siguen explicando todas las muestras
+                    for i in 0 to H-1 loop
+                        if ser_h(D0) /= ref_h(i) then
+                            cand(i) := '0';
+                        end if;
+                    end loop;
+                    n := n + 1;
+                    if n = W_LOCK then
+                        cnt := 0;
+                        for i in 0 to H-1 loop
+                            if cand(i) = '1' then
+                                cnt := cnt + 1;
+                                d := i;
+                            end if;
+                        end loop;
+                        assert cnt = 1
+                            report "LANES=" & integer'image(2*(g+1)) & ": " &
+                                   integer'image(cnt) & " retardos posibles"
+                            severity error;
+                        if cnt /= 1 then
+                            n_err(g) <= n_err(g) + 1;
+                        end if;
+                        locked(g) <= '1';
+                    end if;
+                else
+                    if ser_h(D0) = ref_h(d) then
+                        n_ok(g) <= n_ok(g) + 1;
+                    else
+                        n_err(g) <= n_err(g) + 1;
+                        assert false
+                            report "LANES=" & integer'image(2*(g+1)) & ": muestra " &
+                                   integer'image(ser_h(D0)) & ", esperada " &
+                                   integer'image(ref_h(d))
+                            severity error;
+                    end if;
+                end if;
+            end if;
+        end process;
+    end generate;
+
+    ------------------------------------------------------------------
+    -- Estimulos (dominio del bus)
+    ------------------------------------------------------------------
+    process
+        procedure commit(f : unsigned(31 downto 0); p : unsigned(31 downto 0);
+                         en : std_logic; sel : std_logic) is
+        begin
+            wait until rising_edge(clk_bus);
+            fcw       <= f;
+            pow       <= p;
+            enable    <= en;
+            wave_sel  <= sel;
+            param_req <= not param_req;
+            wait until rising_edge(clk_bus);
+            while param_ack /= (param_req & param_req & param_req) loop
+                wait until rising_edge(clk_bus);
+            end loop;
+        end procedure;
+
+        procedure swap(b : integer) is
+        begin
+            -- a mitad de periodo en los tres nucleos (la tabla es una rampa)
+            wait until rising_edge(clk_f) and (ref_s mod 16 = 1 or ref_s mod 16 = 15) and
+                       ref_s / 16 >= 490 and ref_s / 16 <= 510;
+            wait until rising_edge(clk_bus);
+            bank_sel <= to_unsigned(b, BANK_BITS);
+            bank_req <= not bank_req;
+            wait until rising_edge(clk_bus);
+            while bank_ack /= (bank_req & bank_req & bank_req) loop
+                wait until rising_edge(clk_bus);
+            end loop;
+        end procedure;
+
+        variable ok1 : int_array(0 to 1);
+    begin
+        wait for 100 ns;
+        wait until rising_edge(clk_bus);
+        reset <= '0';
+
+        -- bancos 0 y 1 (todas las copias de carril reciben las escrituras)
+        for b in 0 to 1 loop
+            for i in 0 to 2**PHASE_WIDTH-1 loop
+                wait until rising_edge(clk_bus);
+                ram_we   <= '1';
+                ram_bank <= to_unsigned(b, BANK_BITS);
+                ram_addr <= to_unsigned(i, PHASE_WIDTH);
+                ram_data <= std_logic_vector(to_unsigned(tab(b, i), DAC_WIDTH));
+            end loop;
+        end loop;
+        wait until rising_edge(clk_bus);
+        ram_we <= '0';
+
+        -- fase 1: seno (FCW y POW cargados con la salida parada, asi los
+        -- k*fcw de los carriles ya estan al habilitar)
+        commit(x"0123ABCD", x"10000000", '0', '0');
+        commit(x"0123ABCD", x"10000000", '1', '0');
+        wait for 200 * T_F;
+        chk_en <= '1';
+        wait for 4000 * T_F;
+        ok1 := n_ok;
+        chk_en <= '0';
+        assert locked = "11" report "fase 1: sin enganche" severity error;
+        assert ok1(0) > 3000 and ok1(1) > 3000
+            report "fase 1: pocas muestras comparadas" severity error;
+
+        -- fase 2: AWG, periodo de ~1023 muestras (el wrap rota de carril)
+        commit(x"00401000", x"00000000", '0', '1');
+        commit(x"00401000", x"00000000", '1', '1');
+        wait for 200 * T_F;
+        chk_en <= '1';
+        wait until locked = "11";
+        swap(1);
+        swap(0);
+        swap(1);
+        wait for 1200 * T_F;
+        chk_en <= '0';
+
+        assert n_swap(0) = 3 and n_swap(1) = 3
+            report "no se han visto las 3 conmutaciones de banco" severity error;
+        assert swap_off0(1) > 0
+            report "LANES=4: ninguna conmutacion cayo fuera del carril 0" severity error;
+        assert n_ok(0) - ok1(0) > 3000 and n_ok(1) - ok1(1) > 3000
+            report "fase 2: pocas muestras comparadas" severity error;
+        assert n_err(0) = 0 and n_err(1) = 0
+            report "el entrelazado no coincide con el nucleo de un carril" severity error;
+        report "tb_dds_lanes: LANES=2 " & integer'image(n_ok(0)) & " muestras, LANES=4 " &
+               integer'image(n_ok(1)) & " muestras, conmutaciones fuera del carril 0: " &
+               integer'image(swap_off0(1)) & " (LANES=4), " & integer'image(swap_off0(0)) &
+               " (LANES=2)";
+        done <= true;
+        wait;
+    end process;
+
+end sim;
@@ -6,11 +6,12 @@ use ieee.numeric_std.all;
 entity spi_controller is
    port(
       clk, reset    : in  std_logic;
-      din           : in  std_logic_vector(7 downto 0);
+      din           : in  std_logic_vector(31 downto 0);
       dvsr          : in  std_logic_vector(15 downto 0); 
+      nbits         : in  std_logic_vector(4 downto 0);  -- ancho - 1
       start         : in  std_logic;
       cpol, cpha    : in  std_logic;
-      dout          : out std_logic_vector(7 downto 0);
+      dout          : out std_logic_vector(31 downto 0);
       spi_done_tick : out std_logic;
       ready         : out std_logic;
       sclk          : out std_logic;
@@ -27,9 +28,9 @@ architecture arch of spi_controller is
    signal c_reg, c_next   : unsigned(15 downto 0);
    signal spi_clk_next    : std_logic;
    signal spi_clk_reg     : std_logic;
-   signal n_reg, n_next   : unsigned(2 downto 0);
-   signal si_reg, si_next : std_logic_vector(7 downto 0);
-   signal so_reg, so_next : std_logic_vector(7 downto 0);
+   signal n_reg, n_next   : unsigned(4 downto 0);
+   signal si_reg, si_next : std_logic_vector(31 downto 0);
+   signal so_reg, so_next : std_logic_vector(31 downto 0);
 begin
    -- registros
    process(clk, reset)
@@ -51,7 +52,7 @@ begin
       end if;
    end process;
    -- estado siguiente y tratamiento de datos
-   process(state_reg,si_reg,so_reg,n_reg,c_reg,din,dvsr,start,cpha,miso)
+   process(state_reg,si_reg,so_reg,n_reg,c_reg,din,dvsr,nbits,start,cpha,miso)
    begin
       state_next    <= state_reg;
       ready         <= '0';
@@ -65,6 +66,7 @@ begin
             ready <= '1';
             if start = '1' then
                so_next    <= din;
+               si_next    <= (others => '0');  -- dout sin bits de la palabra anterior
                n_next     <= (others => '0');
                c_next     <= (others => '0');
                state_next <= p0;
@@ -72,18 +74,29 @@ begin
          when p0 =>
             if c_reg = unsigned(dvsr) then -- sclk 0-to-1
                state_next <= p1;
-               si_next    <= si_reg(6 downto 0) & miso;
+               si_next    <= si_reg(30 downto 0) & miso;
                c_next     <= (others => '0');
             else
                c_next <= c_reg + 1;
             end if;
          when p1 =>
             if c_reg = unsigned(dvsr) then -- sclk 1-to-0
-               if n_reg = 7 then
+               if n_reg = unsigned(nbits) then
                   spi_done_tick <= '1';
-                  state_next    <= idle;
+                  -- encadenado: la siguiente palabra arranca en este mismo
+                  -- flanco, sin pasar por idle (sclk sin huecos)
+                  ready         <= '1';
+                  if start = '1' then
+                     so_next    <= din;
+                     si_next    <= (others => '0');
+                     n_next     <= (others => '0');
+                     c_next     <= (others => '0');
+                     state_next <= p0;
+                  else
+                     state_next <= idle;
+                  end if;
                else
-                  so_next    <= so_reg(6 downto 0) & '0';
+                  so_next    <= so_reg(30 downto 0) & '0';
                   state_next <= p0;
                   n_next     <= n_reg + 1;
                   c_next     <= (others => '0');
@@ -99,7 +112,8 @@ begin
    spi_clk_next <= p_clk when (cpol = '0') else not p_clk;
    -- salida
    dout  <= si_reg;
-   mosi  <= so_reg(7);
+   -- msb primero: el bit nbits de la palabra (ancho configurable 1..32)
+   mosi  <= so_reg(to_integer(unsigned(nbits)));
    sclk  <= spi_clk_reg;
 end arch;
 
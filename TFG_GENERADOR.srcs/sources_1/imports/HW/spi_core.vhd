@@ -24,16 +24,33 @@ entity spi_core is
 end spi_core ;
 
 architecture arch of spi_core is
+   constant FIFO_W     : integer := 4;  -- FIFOs tx/rx de 2^FIFO_W palabras
    signal wr_en, wr_ss : std_logic;
    signal wr_ctrl      : std_logic;
    signal wr_spi       : std_logic;
+   signal rd_pop       : std_logic;
+   signal rd_pop_w     : std_logic;
    signal ctrl_reg     : std_logic_vector(31 downto 0);
    signal ss_n_reg     : std_logic_vector(S - 1 downto 0);
-   signal spi_out      : std_logic_vector(7 downto 0);
+   signal spi_out      : std_logic_vector(31 downto 0);
    signal spi_ready    : std_logic;
+   signal spi_done     : std_logic;
+   signal spi_start    : std_logic;
    signal dvsr         : std_logic_vector(15 downto 0);
    signal cpol         : std_logic;
    signal cpha         : std_logic;
+   signal rx_dis       : std_logic;
+   signal nbits        : std_logic_vector(4 downto 0);
+   signal tx_out       : std_logic_vector(31 downto 0);
+   signal tx_empty     : std_logic;
+   signal tx_full      : std_logic;
+   signal tx_level     : std_logic_vector(FIFO_W downto 0);
+   signal rx_wr, rx_rd : std_logic;
+   signal rx_ok        : std_logic;
+   signal rx_out       : std_logic_vector(31 downto 0);
+   signal rx_empty     : std_logic;
+   signal rx_level     : std_logic_vector(FIFO_W downto 0);
+   signal idle         : std_logic;
 begin
    
 -- instancia SPI_controller 
@@ -41,23 +58,53 @@ begin
       port map(
          clk           => clk,
          reset         => reset,
-         din           => wr_data(7 downto 0),
+         din           => tx_out,
          dvsr          => dvsr,
-         start         => wr_spi,
+         nbits         => nbits,
+         start         => spi_start,
          cpol          => cpol,
          cpha          => cpha,
          dout          => spi_out,
          sclk          => spi_sclk,
          miso          => spi_miso,
          mosi          => spi_mosi,
-         spi_done_tick => open,
+         spi_done_tick => spi_done,
          ready         => spi_ready
       );
+   -- FIFO de transmision: la escritura en reg 2 encola, el controlador
+   -- extrae una palabra en cada arranque
+   fifo_tx_unit : entity xil_defaultlib.fifo(reg_file_arch)
+      generic map(DATA_WIDTH => 32, ADDR_WIDTH => FIFO_W)
+      port map(
+         clk    => clk,
+         reset  => reset,
+         rd     => spi_start,
+         wr     => wr_spi,
+         w_data => wr_data,
+         empty  => tx_empty,
+         full   => tx_full,
+         level  => tx_level,
+         r_data => tx_out
+      );
+   -- FIFO de recepcion: una palabra por transferencia terminada (salvo rx_dis)
+   fifo_rx_unit : entity xil_defaultlib.fifo(reg_file_arch)
+      generic map(DATA_WIDTH => 32, ADDR_WIDTH => FIFO_W)
+      port map(
+         clk    => clk,
+         reset  => reset,
+         rd     => rx_rd,
+         wr     => rx_wr,
+         w_data => spi_out,
+         empty  => rx_empty,
+         full   => open,
+         level  => rx_level,
+         r_data => rx_out
+      );
    --registros
    process(clk, reset)
    begin
       if reset = '1' then
-         ctrl_reg <= x"00000200";       -- dvsr=1028 (50 KHz sclk)  
+         ctrl_reg <= x"07000200";       -- 8 bits, dvsr=1028 (50 KHz sclk)  
          ss_n_reg <= (others => '1');   -- de-assert all ss_n
       elsif (clk'event and clk = '1') then
          if (wr_ctrl = '1') then
@@ -71,14 +118,33 @@ begin
    
 --  logica de decodificacin  
    wr_en   <= '1' when cs='1' and write='1' else '0';
-   wr_ss   <= '1' when wr_en='1' and addr(1 downto 0)="01" else '0';
-   wr_spi  <= '1' when wr_en='1' and addr(1 downto 0)="10" else '0';
-   wr_ctrl <= '1' when wr_en='1' and addr(1 downto 0)="11" else '0';
+   wr_ss   <= '1' when wr_en='1' and addr(2 downto 0)="001" else '0';
+   wr_spi  <= '1' when wr_en='1' and addr(2 downto 0)="010" else '0';
+   wr_ctrl <= '1' when wr_en='1' and addr(2 downto 0)="011" else '0';
+   -- lectura con extraccion de la rx FIFO (como en la uart): el MCS
+   -- captura rd_data en el mismo ciclo del strobe de lectura
+   rd_pop   <= '1' when cs='1' and read='1' and addr(2 downto 0)="100" else '0';
+   rd_pop_w <= '1' when cs='1' and read='1' and addr(2 downto 0)="101" else '0';
+   rx_rd    <= (rd_pop or rd_pop_w) and (not rx_empty);
    -- seales de control 
    dvsr     <= ctrl_reg(15 downto 0);
    cpol     <= ctrl_reg(16);
    cpha     <= ctrl_reg(17);
+   rx_dis   <= ctrl_reg(18);
+   nbits    <= ctrl_reg(28 downto 24);
    spi_ss_n <= ss_n_reg;
+   -- arranque encadenado mientras haya datos en la tx FIFO; se detiene si
+   -- la rx FIFO no tiene hueco para la palabra en curso y la siguiente
+   rx_ok     <= '1' when rx_dis = '1' or
+                         unsigned(rx_level) < 2**FIFO_W - 1 else '0';
+   spi_start <= spi_ready and (not tx_empty) and rx_ok;
+   rx_wr     <= spi_done and (not rx_dis);
+   idle      <= spi_ready and tx_empty;
    -- salida de lectura de datos 
-   rd_data  <= x"00000" & "000" & spi_ready & spi_out;
+   -- reg 4: byte bajo + valid (rafagas de 8 bits); reg 5: palabra entera
+   rd_data  <= "00000000000" & rx_level & "0000000" & (not rx_empty) &
+               rx_out(7 downto 0) when addr(2 downto 0)="100" else
+               rx_out when addr(2 downto 0)="101" else
+               "000" & tx_level & "000" & rx_level & "00000" &
+               rx_empty & tx_full & idle & rx_out(7 downto 0);
 end arch;
@@ -14,6 +14,7 @@ entity fifo is
       w_data     : in  std_logic_vector(DATA_WIDTH - 1 downto 0);
       empty      : out std_logic;
       full       : out std_logic;
+      level      : out std_logic_vector(ADDR_WIDTH downto 0);
       r_data     : out std_logic_vector(DATA_WIDTH - 1 downto 0)
    );
 end fifo;
@@ -37,6 +38,7 @@ begin
          wr     => wr,
          empty  => empty,
          full   => full_tmp,
+         level  => level,
          w_addr => w_addr,
          r_addr => r_addr);
    -- instantiate register file
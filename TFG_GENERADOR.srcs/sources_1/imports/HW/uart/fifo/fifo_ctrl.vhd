@@ -7,6 +7,7 @@ entity fifo_ctrl is
       clk, reset  : in  std_logic;
       rd, wr      : in  std_logic;
       empty, full : out std_logic;
+      level       : out std_logic_vector(ADDR_WIDTH downto 0);  -- # palabras
       w_addr      : out std_logic_vector(ADDR_WIDTH-1 downto 0);
       r_addr      : out std_logic_vector(ADDR_WIDTH-1 downto 0)
    );
@@ -82,4 +83,6 @@ begin
    r_addr <= r_ptr_reg;
    full   <= full_reg;
    empty  <= empty_reg;
+   -- ocupacion: con la FIFO llena los punteros coinciden (2^ADDR_WIDTH)
+   level  <= full_reg & std_logic_vector(unsigned(w_ptr_reg) - unsigned(r_ptr_reg));
 end arch;
\ No newline at end of file
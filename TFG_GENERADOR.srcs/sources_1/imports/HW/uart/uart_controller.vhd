@@ -19,6 +19,7 @@ entity uart_controller is
       w_data     : in  std_logic_vector(7 downto 0);
       tx_full    : out std_logic;
       rx_empty   : out std_logic;
+      rx_level   : out std_logic_vector(FIFO_W downto 0);  -- bytes en la rx FIFO
       r_data     : out std_logic_vector(7 downto 0);
       tx         : out std_logic
    );
@@ -69,6 +70,7 @@ begin
          w_data => rx_data_out,
          empty  => rx_empty,
          full   => open,
+         level  => rx_level,
          r_data => r_data
       );
    fifo_tx_unit : entity xil_defaultlib.fifo(reg_file_arch)
@@ -81,6 +83,7 @@ begin
          w_data => w_data,
          empty  => tx_empty,
          full   => tx_full,
+         level  => open,
          r_data => tx_fifo_out
       );
    tx_fifo_not_empty <= not tx_empty;
@@ -5,36 +5,97 @@ use ieee.math_real.all;
 
 entity dds_awg_core is
     generic (
-        PHASE_WIDTH : integer := 10; -- 1024 posiciones (10 bits)
-        DAC_WIDTH   : integer := 14  -- Salida de 14 bits
+        PHASE_WIDTH : integer := 10; -- 1024 posiciones AWG (10 bits)
+        SINE_WIDTH  : integer := 12; -- fase del seno: 4096 posiciones (ROM de 1/4 de onda)
+        DAC_WIDTH   : integer := 14; -- Salida de 14 bits
+        BANK_BITS   : integer := 2;  -- 4 bancos de tabla AWG
+        LANES       : integer := 1   -- muestras por ciclo de clk (1, 2 o 4)
     );
     port (
         clk         : in  std_logic;
         reset       : in  std_logic;
         
-        -- Entradas de Control y Sintonia
-        fcw          : in  unsigned(31 downto 0);
-        phase_offset : in  unsigned(31 downto 0);  -- Desfase inicial (POW)
-        enable       : in  std_logic;
-        wave_sel     : in  std_logic; -- 0: Seno(ROM), 1: Arbitraria(RAM)
+        -- Entradas de Control y Sintonia (dominio del bus)
+        -- Se capturan juntas en clk cuando llega un flanco de
+        -- param_req_tgl; deben mantenerse estables hasta el ack, que
+        -- devuelve en param_ack_tgl el nivel de la peticion.
+        -- Con sync_wait = '1' la captura (y el ack) se aplaza hasta el
+        -- siguiente pulso de sync_pulse, comun a todos los canales.
+        fcw           : in  unsigned(31 downto 0);
+        phase_offset  : in  unsigned(31 downto 0);  -- Desfase inicial (POW)
+        enable        : in  std_logic;
+        wave_sel      : in  std_logic; -- 0: Seno(ROM), 1: Arbitraria(RAM)
+        phase_rst     : in  std_logic; -- 1: el commit reinicia el acumulador
+        sync_wait     : in  std_logic; -- 1: el commit espera al pulso de sync
+        sync_pulse    : in  std_logic; -- pulso de 1 ciclo de clk, compartido
+        param_req_tgl : in  std_logic;
+        param_ack_tgl : out std_logic;
+        
+        -- Barrido de frecuencia (se capturan con el mismo commit)
+        --  sweep_ctrl(0): run, el barrido gobierna el FCW efectivo
+        --  sweep_ctrl(2 downto 1): 00 parada en stop, 01 bucle, 10 ida y vuelta
+        --  sweep_ctrl(3): 0 lineal (+/- step), 1 logaritmico (+/- fcw*step/2^16)
+        --  sweep_ctrl(4): go, el commit (re)arranca el barrido desde start
+        sweep_start   : in  unsigned(31 downto 0);  -- FCW inicial
+        sweep_stop    : in  unsigned(31 downto 0);  -- FCW final
+        sweep_step    : in  unsigned(31 downto 0);  -- incremento (lineal) o ratio Q0.16 (log)
+        sweep_dwell   : in  unsigned(31 downto 0);  -- ciclos de clk por escalon (>= 2)
+        sweep_ctrl    : in  std_logic_vector(4 downto 0);
+        sweep_active  : out std_logic;  -- barrido en marcha (no ha llegado a stop)
         
         -- Puerto A de la Memoria Arbitraria (Escritura desde C++)
-        ram_we      : in  std_logic;
-        ram_addr_in : in  unsigned(PHASE_WIDTH-1 downto 0);
-        ram_data_in : in  std_logic_vector(DAC_WIDTH-1 downto 0);
+        -- Sincrono con ram_clk (reloj del bus). Con ram_pair = '1' se
+        -- escriben dos muestras en el mismo ciclo: ram_data_in en
+        -- ram_addr_in y ram_data2_in en ram_addr_in + 1.
+        ram_clk      : in  std_logic;
+        ram_we       : in  std_logic;
+        ram_bank_in  : in  unsigned(BANK_BITS-1 downto 0);  -- Banco destino
+        ram_pair     : in  std_logic;
+        ram_addr_in  : in  unsigned(PHASE_WIDTH-1 downto 0);
+        ram_data_in  : in  std_logic_vector(DAC_WIDTH-1 downto 0);
+        ram_data2_in : in  std_logic_vector(DAC_WIDTH-1 downto 0);
+        -- Lectura por el mismo puerto (ram_clk) cuando ram_we = '0':
+        -- par de muestras banco & scan_addr, un ciclo de latencia
+        scan_addr    : in  unsigned(BANK_BITS+PHASE_WIDTH-2 downto 0);
+        scan_even    : out std_logic_vector(DAC_WIDTH-1 downto 0);
+        scan_odd     : out std_logic_vector(DAC_WIDTH-1 downto 0);
+        
+        -- Conmutacion de banco AWG (peticion desde el dominio del bus)
+        -- Cada flanco de bank_req_tgl pide reproducir bank_sel; el cambio
+        -- se aplica en el siguiente desbordamiento del acumulador de fase
+        -- (o de inmediato con enable = '0') y se confirma devolviendo en
+        -- bank_ack_tgl el nivel de bank_req_tgl. bank_sel se registra en
+        -- clk al detectar el flanco sincronizado, asi que debe mantenerse
+        -- estable hasta el ack (el slot ignora BANK_PLAY con una
+        -- peticion pendiente).
+        bank_sel     : in  unsigned(BANK_BITS-1 downto 0);
+        bank_req_tgl : in  std_logic;
+        bank_ack_tgl : out std_logic;
         
         -- Salida Digital Analógica
-        dac_out     : out std_logic_vector(DAC_WIDTH-1 downto 0)
+        -- LANES muestras por ciclo de clk (tasa efectiva LANES * f_clk);
+        -- carril k en los bits (k+1)*DAC_WIDTH-1 .. k*DAC_WIDTH, el
+        -- carril 0 es la muestra mas antigua (orden de serializacion)
+        dac_out     : out std_logic_vector(LANES*DAC_WIDTH-1 downto 0)
     );
 end dds_awg_core;
 
 architecture rtl of dds_awg_core is
 
     ------------------------------------------------------------------
-    -- 1. ROM Senoidal Constante (Generada en síntesis)
+    -- 1. ROM Senoidal de 1/4 de onda (Generada en síntesis)
     ------------------------------------------------------------------
-    constant ROM_DEPTH : integer := 2**PHASE_WIDTH;
-    type memory_type is array (0 to ROM_DEPTH-1) of std_logic_vector(DAC_WIDTH-1 downto 0);
+    -- Solo se guarda la amplitud del primer cuadrante, muestreada en el
+    -- centro de cada paso (i + 0.5) para que el espejo sea exacto:
+    --   fase = cuadrante(2 bits) & indice(SINE_WIDTH-2 bits)
+    --   cuadrantes 1 y 3: indice invertido (bit a bit)
+    --   cuadrantes 2 y 3: amplitud negada (bit a bit) y sin el MSB
+    -- La salida es simetrica respecto a 2**(DAC_WIDTH-1) - 0.5. Con
+    -- SINE_WIDTH = 12 ocupa lo mismo que la antigua tabla completa de
+    -- 1024 muestras, con 4 veces mas resolucion de fase.
+    constant ROM_DEPTH : integer := 2**(SINE_WIDTH-2);
+    constant AMP_WIDTH : integer := DAC_WIDTH-1;
+    type memory_type is array (0 to ROM_DEPTH-1) of std_logic_vector(AMP_WIDTH-1 downto 0);
 
     function init_sin_rom return memory_type is
         variable rom : memory_type;
@@ -42,12 +103,12 @@ architecture rtl of dds_awg_core is
         variable val : integer;
     begin
         for i in 0 to ROM_DEPTH-1 loop
-            x := real(i) * 2.0 * MATH_PI / real(ROM_DEPTH);
+            x := (real(i) + 0.5) * MATH_PI / (2.0 * real(ROM_DEPTH));
             y := sin(x);
-            val := integer(round((y + 1.0) * (real((2**DAC_WIDTH) - 1) / 2.0)));
-            if val > ((2**DAC_WIDTH) - 1) then val := (2**DAC_WIDTH) - 1; end if;
+            val := integer(round(y * (real(2**AMP_WIDTH) - 0.5) - 0.5));
+            if val > ((2**AMP_WIDTH) - 1) then val := (2**AMP_WIDTH) - 1; end if;
             if val < 0 then val := 0; end if;
-            rom(i) := std_logic_vector(to_unsigned(val, DAC_WIDTH));
+            rom(i) := std_logic_vector(to_unsigned(val, AMP_WIDTH));
         end loop;
         return rom;
     end function;
@@ -55,86 +116,401 @@ architecture rtl of dds_awg_core is
     constant SIN_ROM : memory_type := init_sin_rom;
 
     ------------------------------------------------------------------
-    -- 2. RAM Arbitraria Inferida (AWG) - Dual Port
+    -- 2. RAM Arbitraria Inferida (AWG) - Dual Port, doble reloj
     ------------------------------------------------------------------
-    -- Puerto A: Escritura desde Bus. Puerto B: Lectura DDS
-    signal awg_ram : memory_type := (others => (others => '0'));
+    -- Puerto A: Escritura desde Bus (ram_clk). Puerto B: Lectura DDS (clk)
+    -- Entrelazada en dos medias RAM (direcciones pares / impares) para
+    -- poder escribir un par de muestras consecutivas en un solo ciclo.
+    -- Cada media RAM contiene los 2**BANK_BITS bancos: indice = banco & addr.
+    -- Con LANES > 1 cada carril lee de su propia copia (todas reciben las
+    -- mismas escrituras): cada BRAM solo tiene un puerto de lectura libre.
+    constant HALF_DEPTH : integer := 2**(PHASE_WIDTH-1+BANK_BITS);
+    type half_memory_type is array (0 to HALF_DEPTH-1) of std_logic_vector(DAC_WIDTH-1 downto 0);
+
+    signal ram_addr_next : unsigned(PHASE_WIDTH-1 downto 0);
+    signal we_even       : std_logic;
+    signal we_odd        : std_logic;
+    signal addr_even     : unsigned(BANK_BITS+PHASE_WIDTH-2 downto 0);
+    signal addr_odd      : unsigned(BANK_BITS+PHASE_WIDTH-2 downto 0);
+    signal data_even     : std_logic_vector(DAC_WIDTH-1 downto 0);
+    signal data_odd      : std_logic_vector(DAC_WIDTH-1 downto 0);
+    signal port_a_even   : unsigned(BANK_BITS+PHASE_WIDTH-2 downto 0);
+    signal port_a_odd    : unsigned(BANK_BITS+PHASE_WIDTH-2 downto 0);
 
     ------------------------------------------------------------------
     -- Señales Internas
     ------------------------------------------------------------------
     signal phase_acc   : unsigned(31 downto 0);
-    signal phase_trunc : unsigned(PHASE_WIDTH-1 downto 0);
+    signal phase_sum   : unsigned(32 downto 0);  -- bit 32: desbordamiento
+    
+    -- Carriles polifase: el carril k genera la muestra phase_acc + k*fcw
+    type lane_word_type   is array (0 to LANES) of unsigned(31 downto 0);
+    type lane_sum_type    is array (0 to LANES-1) of unsigned(32 downto 0);
+    type lane_sample_type is array (0 to LANES-1) of std_logic_vector(DAC_WIDTH-1 downto 0);
+    signal lane_off    : lane_word_type;  -- k * fcw_eff (registrado)
+    signal lane_sum    : lane_sum_type;   -- bit 32: el carril ya ha pasado el wrap
+    signal scan_even_l : lane_sample_type;  -- lectura por el puerto A (solo carril 0)
+    signal scan_odd_l  : lane_sample_type;
+    
+    -- Parametros activos (dominio clk), actualizados de forma atomica
+    signal fcw_act      : unsigned(31 downto 0);
+    signal pow_act      : unsigned(31 downto 0);
+    signal enable_act   : std_logic;
+    signal wave_sel_act : std_logic;
+    signal param_req_s  : std_logic_vector(2 downto 0);  -- 2 FF + flanco
+    signal param_load   : std_logic;  -- llegada del commit
+    signal param_armed  : std_logic;  -- commit a la espera de sync
+    signal param_apply  : std_logic;  -- ciclo de captura del commit
+    signal param_ack    : std_logic;
     
-    signal sine_val_raw    : std_logic_vector(DAC_WIDTH-1 downto 0);
-    signal awg_val_raw     : std_logic_vector(DAC_WIDTH-1 downto 0);
-    signal sine_val    : std_logic_vector(DAC_WIDTH-1 downto 0);
-    signal awg_val     : std_logic_vector(DAC_WIDTH-1 downto 0);
-    signal out_reg     : std_logic_vector(DAC_WIDTH-1 downto 0);
+    -- Barrido de frecuencia (dominio clk)
+    signal sw_start_act  : unsigned(31 downto 0);
+    signal sw_stop_act   : unsigned(31 downto 0);
+    signal sw_step_act   : unsigned(31 downto 0);
+    signal sw_dwell_act  : unsigned(31 downto 0);
+    signal sw_en_act     : std_logic;  -- el barrido gobierna el FCW
+    signal sw_mode_act   : std_logic_vector(1 downto 0);
+    signal sw_log_act    : std_logic;
+    signal sweep_fcw     : unsigned(31 downto 0);
+    signal sweep_run     : std_logic;
+    signal sweep_back    : std_logic;  -- tramo de vuelta (modo ida y vuelta)
+    signal sweep_up      : std_logic;  -- stop >= start
+    signal moving_up     : std_logic;
+    signal dwell_cnt     : unsigned(31 downto 0);
+    signal sweep_prod    : unsigned(47 downto 0);  -- fcw * ratio (1 ciclo de latencia)
+    signal sweep_inc     : unsigned(31 downto 0);
+    signal sweep_next    : signed(33 downto 0);
+    signal sweep_target  : unsigned(31 downto 0);
+    signal sweep_reached : std_logic;
+    signal fcw_eff       : unsigned(31 downto 0);  -- FCW que entra al acumulador
+    
+    -- Banco AWG activo (dominio clk) y sincronizacion de la peticion
+    signal bank_active  : unsigned(BANK_BITS-1 downto 0);
+    signal bank_next    : unsigned(BANK_BITS-1 downto 0);  -- bank_sel en clk
+    signal bank_req_s   : std_logic_vector(2 downto 0);  -- 2 FF + flanco
+    signal bank_pending : std_logic;
+    signal bank_ack     : std_logic;
+    
+    signal sine_val    : lane_sample_type;
+    signal awg_val     : lane_sample_type;
+    signal out_reg     : std_logic_vector(LANES*DAC_WIDTH-1 downto 0);
 
 begin
 
+    ------------------------------------------------------------------
+    -- Commit atomico de FCW/POW/CTRL (dominio del bus -> clk)
+    ------------------------------------------------------------------
+    -- Las entradas llevan estables desde antes del flanco de la peticion,
+    -- que ha atravesado 2 FF: se pueden capturar todas a la vez.
+    -- El acumulador de fase NO se toca: un cambio de FCW/POW es continuo
+    -- en fase salvo que se pida phase_rst.
+    -- Un commit con sync_wait queda armado: las entradas siguen estables
+    -- (no hay ack) y se capturan con sync_pulse, en el mismo ciclo en
+    -- todos los canales armados. Si el pulso llega en el mismo ciclo que
+    -- el commit, se aplica ya (si no, este canal esperaria al siguiente
+    -- sync y se desalinearia del resto).
+    param_load  <= param_req_s(2) xor param_req_s(1);
+    param_apply <= (param_load and not sync_wait) or
+                   (sync_pulse and (param_armed or (param_load and sync_wait)));
+
+    process(clk, reset)
+    begin
+        if reset = '1' then
+            param_req_s  <= (others => '0');
+            param_ack    <= '0';
+            param_armed  <= '0';
+            fcw_act      <= (others => '0');
+            pow_act      <= (others => '0');
+            enable_act   <= '0';
+            wave_sel_act <= '0';
+        elsif rising_edge(clk) then
+            param_req_s <= param_req_s(1 downto 0) & param_req_tgl;
+            if param_load = '1' and sync_wait = '1' then
+                param_armed  <= '1';
+            end if;
+            if param_apply = '1' then
+                fcw_act      <= fcw;
+                pow_act      <= phase_offset;
+                enable_act   <= enable;
+                wave_sel_act <= wave_sel;
+                param_armed  <= '0';
+                param_ack    <= param_req_s(1);  -- eco del nivel de la peticion
+            end if;
+        end if;
+    end process;
+
+    param_ack_tgl <= param_ack;
+
+    ------------------------------------------------------------------
+    -- Motor de barrido de frecuencia (chirp)
+    ------------------------------------------------------------------
+    -- Cada sw_dwell_act ciclos el FCW del barrido avanza un escalon hacia
+    -- el objetivo (stop, o start en el tramo de vuelta). El escalon es
+    -- sw_step_act (lineal) o sweep_fcw*ratio/2^16 (logaritmico, minimo 1);
+    -- el producto va registrado, por eso el dwell minimo es de 2 ciclos.
+    -- Las comparaciones se hacen con signo en 34 bits para que el ultimo
+    -- escalon no desborde. Al llegar al objetivo:
+    --   parada      -> se queda en stop y sweep_active baja
+    --   bucle       -> vuelve a start
+    --   ida y vuelta-> invierte el sentido
+    sweep_up     <= '1' when sw_stop_act >= sw_start_act else '0';
+    moving_up    <= sweep_up xor sweep_back;
+    sweep_target <= sw_start_act when sweep_back = '1' else sw_stop_act;
+
+    sweep_inc <= to_unsigned(1, 32) when sw_log_act = '1' and sweep_prod(47 downto 16) = 0 else
+                 sweep_prod(47 downto 16) when sw_log_act = '1' else
+                 sw_step_act;
+
+    sweep_next <= signed("00" & sweep_fcw) + signed("00" & sweep_inc) when moving_up = '1' else
+                  signed("00" & sweep_fcw) - signed("00" & sweep_inc);
+
+    sweep_reached <= '1' when (moving_up = '1' and sweep_next >= signed("00" & sweep_target)) or
+                              (moving_up = '0' and sweep_next <= signed("00" & sweep_target)) else '0';
+
+    process(clk, reset)
+    begin
+        if reset = '1' then
+            sw_start_act <= (others => '0');
+            sw_stop_act  <= (others => '0');
+            sw_step_act  <= (others => '0');
+            sw_dwell_act <= (others => '0');
+            sw_en_act    <= '0';
+            sw_mode_act  <= (others => '0');
+            sw_log_act   <= '0';
+            sweep_fcw    <= (others => '0');
+            sweep_run    <= '0';
+            sweep_back   <= '0';
+            dwell_cnt    <= (others => '0');
+            sweep_prod   <= (others => '0');
+        elsif rising_edge(clk) then
+            sweep_prod <= sweep_fcw * sw_step_act(15 downto 0);
+            if param_apply = '1' then
+                sw_start_act <= sweep_start;
+                sw_stop_act  <= sweep_stop;
+                sw_step_act  <= sweep_step;
+                sw_dwell_act <= sweep_dwell;
+                sw_en_act    <= sweep_ctrl(0);
+                sw_mode_act  <= sweep_ctrl(2 downto 1);
+                sw_log_act   <= sweep_ctrl(3);
+                if sweep_ctrl(0) = '0' then
+                    sweep_run <= '0';
+                elsif sweep_ctrl(4) = '1' then
+                    sweep_fcw  <= sweep_start;
+                    sweep_run  <= '1';
+                    sweep_back <= '0';
+                    dwell_cnt  <= (others => '0');
+                end if;
+            elsif sweep_run = '1' then
+                if dwell_cnt + 1 >= sw_dwell_act then
+                    dwell_cnt <= (others => '0');
+                    if sweep_reached = '1' then
+                        case sw_mode_act is
+                            when "00" =>      -- parada en stop
+                                sweep_fcw <= sw_stop_act;
+                                sweep_run <= '0';
+                            when "01" =>      -- bucle (diente de sierra)
+                                sweep_fcw <= sw_start_act;
+                            when others =>    -- ida y vuelta (triangular)
+                                sweep_fcw  <= sweep_target;
+                                sweep_back <= not sweep_back;
+                        end case;
+                    else
+                        sweep_fcw <= unsigned(sweep_next(31 downto 0));
+                    end if;
+                else
+                    dwell_cnt <= dwell_cnt + 1;
+                end if;
+            end if;
+        end if;
+    end process;
+
+    fcw_eff      <= sweep_fcw when sw_en_act = '1' else fcw_act;
+    sweep_active <= sweep_run;
+
     ------------------------------------------------------------------
     -- Acumulador de Fase
     ------------------------------------------------------------------
+    -- Avanza LANES*fcw por ciclo. Los multiplos k*fcw se registran (un
+    -- ciclo de latencia tras un cambio de FCW, igual en todos los
+    -- carriles, asi el entrelazado sigue siendo coherente).
+    process(clk, reset)
+    begin
+        if reset = '1' then
+            lane_off <= (others => (others => '0'));
+        elsif rising_edge(clk) then
+            for k in 0 to LANES loop
+                lane_off(k) <= resize(fcw_eff * to_unsigned(k, 4), 32);
+            end loop;
+        end if;
+    end process;
+
+    phase_sum <= ('0' & phase_acc) + ('0' & lane_off(LANES));
+
     process(clk, reset)
     begin
         if reset = '1' then
             phase_acc <= (others => '0');
         elsif rising_edge(clk) then
-            if enable = '1' then
-                phase_acc <= phase_acc + fcw;
+            if param_apply = '1' and phase_rst = '1' then
+                phase_acc <= (others => '0');  -- reinicio de fase sin pasar por mid-scale
+            elsif enable_act = '1' then
+                phase_acc <= phase_sum(31 downto 0);
             else
                 phase_acc <= (others => '0');
             end if;
         end if;
     end process;
 
-    -- Sumar desfase y extraer los bits MSB para direccionar la memoria
-    phase_trunc <= (phase_acc(31 downto 32-PHASE_WIDTH) + phase_offset(31 downto 32-PHASE_WIDTH));
-  
+    gen_lane_sum : for k in 0 to LANES-1 generate
+        lane_sum(k) <= ('0' & phase_acc) + ('0' & lane_off(k));
+    end generate;
 
     ------------------------------------------------------------------
-    -- Memorias (Pipeline de 2 etapas)
+    -- Conmutacion de banco AWG sin glitch
     ------------------------------------------------------------------
-    process(clk)
+    -- El banco cambia en el mismo flanco en que el acumulador desborda,
+    -- asi la primera direccion de la nueva vuelta ya lee el banco nuevo.
+    -- Con varios carriles, los que en ese ciclo ya han pasado el wrap
+    -- (lane_sum(k)(32)) leen el banco nuevo (ver gen_lane).
+    process(clk, reset)
     begin
-        if rising_edge(clk) then
-            -- Puerto A RAM: Escritura (desde MicroBlaze)
-            if ram_we = '1' then
-                awg_ram(to_integer(ram_addr_in)) <= ram_data_in;
+        if reset = '1' then
+            bank_req_s   <= (others => '0');
+            bank_pending <= '0';
+            bank_active  <= (others => '0');
+            bank_next    <= (others => '0');
+            bank_ack     <= '0';
+        elsif rising_edge(clk) then
+            bank_req_s <= bank_req_s(1 downto 0) & bank_req_tgl;
+            if bank_req_s(2) /= bank_req_s(1) then
+                -- bank_sel lleva estable desde antes del flanco de la
+                -- peticion: se captura una vez en el dominio clk
+                bank_next    <= bank_sel;
+                bank_pending <= '1';
+            elsif bank_pending = '1' and (enable_act = '0' or phase_sum(32) = '1') then
+                bank_active  <= bank_next;
+                bank_pending <= '0';
+                bank_ack     <= bank_req_s(2);  -- eco del nivel de la peticion
             end if;
-            
-            -- ETAPA 1: Lectura cruda de la memoria
-            sine_val_raw <= SIN_ROM(to_integer(phase_trunc));
-            awg_val_raw  <= awg_ram(to_integer(phase_trunc));
-            
-            -- ETAPA 2: Registro intermedio 
-            sine_val <= sine_val_raw;
-            awg_val  <= awg_val_raw;
         end if;
     end process;
 
+    bank_ack_tgl <= bank_ack;
+
+    ------------------------------------------------------------------
+    -- Puerto A RAM: Escritura (desde MicroBlaze, dominio ram_clk)
+    ------------------------------------------------------------------
+    -- La muestra en ram_addr_in va a la media RAM de su paridad; con
+    -- ram_pair la muestra de ram_addr_in + 1 va a la otra media RAM.
+    ram_addr_next <= ram_addr_in + 1;
+
+    we_even <= ram_we when (ram_addr_in(0) = '0' or ram_pair = '1') else '0';
+    we_odd  <= ram_we when (ram_addr_in(0) = '1' or ram_pair = '1') else '0';
+
+    addr_even <= ram_bank_in & ram_addr_in(PHASE_WIDTH-1 downto 1) when ram_addr_in(0) = '0' else
+                 ram_bank_in & ram_addr_next(PHASE_WIDTH-1 downto 1);
+    addr_odd  <= ram_bank_in & ram_addr_in(PHASE_WIDTH-1 downto 1);
+
+    data_even <= ram_data_in when ram_addr_in(0) = '0' else ram_data2_in;
+    data_odd  <= ram_data_in when ram_addr_in(0) = '1' else ram_data2_in;
+
+    -- Direccion unica del puerto A: escritura o, si no se escribe, lectura
+    port_a_even <= addr_even when ram_we = '1' else scan_addr;
+    port_a_odd  <= addr_odd  when ram_we = '1' else scan_addr;
+
+    ------------------------------------------------------------------
+    -- Carriles: ROM/RAM y pipeline de 2 etapas por carril
+    ------------------------------------------------------------------
+    gen_lane : for k in 0 to LANES-1 generate
+        signal awg_ram_even : half_memory_type := (others => (others => '0'));
+        signal awg_ram_odd  : half_memory_type := (others => (others => '0'));
+        signal phase_trunc  : unsigned(PHASE_WIDTH-1 downto 0);
+        signal sine_phase   : unsigned(SINE_WIDTH-1 downto 0);
+        signal sine_addr    : unsigned(SINE_WIDTH-3 downto 0);  -- indice plegado
+        signal rd_bank      : unsigned(BANK_BITS-1 downto 0);
+        signal rd_addr      : unsigned(BANK_BITS+PHASE_WIDTH-2 downto 0);
+        signal sine_amp_raw : std_logic_vector(AMP_WIDTH-1 downto 0);
+        signal sine_neg_raw : std_logic;
+        signal awg_even_raw : std_logic_vector(DAC_WIDTH-1 downto 0);
+        signal awg_odd_raw  : std_logic_vector(DAC_WIDTH-1 downto 0);
+        signal awg_sel_raw  : std_logic;
+    begin
+        -- Sumar desfase y extraer los bits MSB para direccionar la memoria
+        phase_trunc <= (lane_sum(k)(31 downto 32-PHASE_WIDTH) + pow_act(31 downto 32-PHASE_WIDTH));
+        sine_phase  <= (lane_sum(k)(31 downto 32-SINE_WIDTH) + pow_act(31 downto 32-SINE_WIDTH));
+
+        -- Plegado por simetria: espejo del indice en los cuadrantes 1 y 3
+        sine_addr <= not sine_phase(SINE_WIDTH-3 downto 0) when sine_phase(SINE_WIDTH-2) = '1' else
+                     sine_phase(SINE_WIDTH-3 downto 0);
+
+        rd_bank <= bank_next when bank_pending = '1' and lane_sum(k)(32) = '1' else bank_active;
+        rd_addr <= rd_bank & phase_trunc(PHASE_WIDTH-1 downto 1);
+
+        process(ram_clk)
+        begin
+            if rising_edge(ram_clk) then
+                if we_even = '1' then
+                    awg_ram_even(to_integer(port_a_even)) <= data_even;
+                end if;
+                if we_odd = '1' then
+                    awg_ram_odd(to_integer(port_a_odd)) <= data_odd;
+                end if;
+                scan_even_l(k) <= awg_ram_even(to_integer(port_a_even));
+                scan_odd_l(k)  <= awg_ram_odd(to_integer(port_a_odd));
+            end if;
+        end process;
+
+        process(clk)
+        begin
+            if rising_edge(clk) then
+                -- ETAPA 1: Lectura cruda de la memoria
+                sine_amp_raw <= SIN_ROM(to_integer(sine_addr));
+                sine_neg_raw <= sine_phase(SINE_WIDTH-1);  -- semiciclo negativo
+                awg_even_raw <= awg_ram_even(to_integer(rd_addr));
+                awg_odd_raw  <= awg_ram_odd(to_integer(rd_addr));
+                awg_sel_raw  <= phase_trunc(0);
+                
+                -- ETAPA 2: Registro intermedio 
+                if sine_neg_raw = '0' then
+                    sine_val(k) <= '1' & sine_amp_raw;
+                else
+                    sine_val(k) <= '0' & not sine_amp_raw;
+                end if;
+                if awg_sel_raw = '0' then
+                    awg_val(k) <= awg_even_raw;
+                else
+                    awg_val(k) <= awg_odd_raw;
+                end if;
+            end if;
+        end process;
+    end generate;
+
     ------------------------------------------------------------------
     -- Multiplexor y Registro de Salida
     ------------------------------------------------------------------
     process(clk, reset)
     begin
         if reset = '1' then
-            out_reg <= std_logic_vector(to_unsigned(2**(DAC_WIDTH-1), DAC_WIDTH)); -- mid-scale
+            for k in 0 to LANES-1 loop
+                out_reg((k+1)*DAC_WIDTH-1 downto k*DAC_WIDTH) <= std_logic_vector(to_unsigned(2**(DAC_WIDTH-1), DAC_WIDTH)); -- mid-scale
+            end loop;
         elsif rising_edge(clk) then
-            if enable = '0' then
-                out_reg <= std_logic_vector(to_unsigned(2**(DAC_WIDTH-1), DAC_WIDTH)); -- mid-scale
-            else
-                if wave_sel = '0' then
-                    out_reg <= sine_val;
+            for k in 0 to LANES-1 loop
+                if enable_act = '0' then
+                    out_reg((k+1)*DAC_WIDTH-1 downto k*DAC_WIDTH) <= std_logic_vector(to_unsigned(2**(DAC_WIDTH-1), DAC_WIDTH)); -- mid-scale
+                elsif wave_sel_act = '0' then
+                    out_reg((k+1)*DAC_WIDTH-1 downto k*DAC_WIDTH) <= sine_val(k);
                 else
-                    out_reg <= awg_val;
+                    out_reg((k+1)*DAC_WIDTH-1 downto k*DAC_WIDTH) <= awg_val(k);
                 end if;
-            end if;
+            end loop;
         end if;
     end process;
 
     dac_out <= out_reg;
 
+    -- todas las copias de la RAM tienen el mismo contenido
+    scan_even <= scan_even_l(0);
+    scan_odd  <= scan_odd_l(0);
+
 end rtl;
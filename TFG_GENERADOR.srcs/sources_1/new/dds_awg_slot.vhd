@@ -7,7 +7,12 @@ entity dds_awg_slot is
         ADDR_WIDTH  : integer := 5;  -- 5 bits = 32 registros por slot
         DATA_WIDTH  : integer := 32; -- Ancho del bus
         PHASE_WIDTH : integer := 10; 
-        DAC_WIDTH   : integer := 14
+        SINE_WIDTH  : integer := 12; -- fase del seno (ROM de 1/4 de onda)
+        DAC_WIDTH   : integer := 14;
+        BANK_BITS   : integer := 2;  -- 4 bancos AWG
+        LANES       : integer := 1   -- muestras por ciclo de clk_dds (1, 2 o 4)
+        -- En el MMIO LANES = DDS_LANES (io_map), que debe coincidir con
+        -- DDS_LANES de io_map.h; el MMIO solo admite 1 (dac_out de 14 bits)
     );
     port(
         clk         : in  std_logic;
@@ -22,22 +27,97 @@ entity dds_awg_slot is
         rd_data     : out std_logic_vector(DATA_WIDTH-1 downto 0);
         wr_data     : in  std_logic_vector(DATA_WIDTH-1 downto 0);
         
-        -- Salida fisica hacia el DAC
-        dac_out     : out std_logic_vector(DAC_WIDTH-1 downto 0)
+        -- Sincronismo multicanal (dominio clk_dds)
+        -- sync_out: pulso generado por la escritura en SYNC (offset 14),
+        -- sincronizado una sola vez a clk_dds. En el MMIO el sync_out del
+        -- canal maestro se reparte al sync_in de todos los canales.
+        sync_in     : in  std_logic;
+        sync_out    : out std_logic;
+        
+        -- Salida fisica hacia el DAC (LANES muestras por ciclo de clk_dds,
+        -- carril 0 en los bits bajos; con LANES > 1 va a un serializador)
+        dac_out     : out std_logic_vector(LANES*DAC_WIDTH-1 downto 0)
     );
 end dds_awg_slot;
 
 architecture arch of dds_awg_slot is
 
     -- Registros mapeados en memoria (MMIO)
+    -- fcw_reg, ctrl_reg, pow_reg y los registros de barrido son registros
+    -- sombra: no afectan al DDS hasta que se escribe COMMIT (offset 8).
     signal fcw_reg      : unsigned(31 downto 0);
-    signal ctrl_reg     : std_logic_vector(1 downto 0);
+    signal ctrl_reg     : std_logic_vector(3 downto 0);
     signal ram_addr_reg : unsigned(PHASE_WIDTH-1 downto 0);
     signal pow_reg      : unsigned(31 downto 0);  -- Phase Offset Word
+    signal sw_start_reg : unsigned(31 downto 0);  -- Barrido: FCW inicial
+    signal sw_step_reg  : unsigned(31 downto 0);  -- Barrido: incremento / ratio
+    signal sw_dwell_reg : unsigned(31 downto 0);  -- Barrido: ciclos por escalon
+    signal sw_stop_reg  : unsigned(31 downto 0);  -- Barrido: FCW final
+    signal sw_ctrl_reg  : std_logic_vector(4 downto 0);
+    
+    -- Copia estable de los parametros mientras cruzan a clk_dds
+    signal fcw_xfer     : unsigned(31 downto 0);
+    signal ctrl_xfer    : std_logic_vector(3 downto 0);
+    signal pow_xfer     : unsigned(31 downto 0);
+    signal sw_start_xfer: unsigned(31 downto 0);
+    signal sw_step_xfer : unsigned(31 downto 0);
+    signal sw_dwell_xfer: unsigned(31 downto 0);
+    signal sw_stop_xfer : unsigned(31 downto 0);
+    signal sw_ctrl_xfer : std_logic_vector(4 downto 0);
+    signal sweep_active : std_logic;
+    signal sweep_act_s  : std_logic_vector(1 downto 0);  -- sincronizador 2 FF
+    signal sync_req_tgl : std_logic;
+    signal sync_req_s   : std_logic_vector(2 downto 0);  -- 2 FF + flanco (clk_dds)
+    signal param_req_tgl: std_logic;
+    signal param_ack_tgl: std_logic;
+    signal param_ack_s  : std_logic_vector(1 downto 0);  -- sincronizador 2 FF
+    signal param_pending: std_logic;
+    signal bank_wr_reg  : unsigned(BANK_BITS-1 downto 0);  -- Banco destino de escrituras
+    signal bank_play_reg: unsigned(BANK_BITS-1 downto 0);  -- Banco a reproducir (peticion)
+    signal bank_req_tgl : std_logic;
+    signal bank_ack_tgl : std_logic;
+    signal bank_ack_s   : std_logic_vector(1 downto 0);  -- sincronizador 2 FF
+    signal bank_pending : std_logic;
+    signal status_word  : std_logic_vector(DATA_WIDTH-1 downto 0);
+    
+    -- CRC32 (IEEE 802.3, reflejado) de las muestras AWG
+    --  crc_wr:   de cada muestra escrita desde el ultimo reset (offset 15)
+    --  crc_scan: del contenido del banco BANK_WR, leido por el puerto de
+    --            escritura de la RAM cuando el bus no escribe (offset 16)
+    -- Cada muestra cuenta como 16 bits (14 bits + 2 ceros), LSB primero.
+    signal crc_wr       : std_logic_vector(31 downto 0);
+    signal crc_scan     : std_logic_vector(31 downto 0);
+    signal scan_busy    : std_logic;
+    signal scan_run     : std_logic;  -- quedan direcciones por emitir
+    signal scan_issue   : std_logic;  -- lectura emitida el ciclo anterior
+    signal scan_last    : std_logic;  -- ... y era la ultima
+    signal scan_idx     : unsigned(PHASE_WIDTH-2 downto 0);  -- par de muestras
+    signal scan_bank    : unsigned(BANK_BITS-1 downto 0);
+    signal scan_addr    : unsigned(BANK_BITS+PHASE_WIDTH-2 downto 0);
+    signal scan_even    : std_logic_vector(DAC_WIDTH-1 downto 0);
+    signal scan_odd     : std_logic_vector(DAC_WIDTH-1 downto 0);
+    signal crc_sample   : std_logic_vector(31 downto 0);  -- muestra(s) del bus con relleno
     
     -- Senales de interconexion con el Core
     signal wr_en        : std_logic;
     signal ram_we_pulse : std_logic;
+    signal ram_pair     : std_logic;
+
+    -- actualiza el CRC32 reflejado con los bits de d, LSB primero
+    function crc32_upd(crc : std_logic_vector(31 downto 0); d : std_logic_vector)
+        return std_logic_vector is
+        variable c  : std_logic_vector(31 downto 0) := crc;
+        variable fb : std_logic;
+    begin
+        for i in d'low to d'high loop
+            fb := c(0) xor d(i);
+            c  := '0' & c(31 downto 1);
+            if fb = '1' then
+                c := c xor x"EDB88320";
+            end if;
+        end loop;
+        return c;
+    end function;
 
 begin
 
@@ -46,7 +126,10 @@ begin
     ------------------------------------------------------------------
     wr_en <= '1' when write = '1' and cs = '1' else '0';
 
-    -- Escritura a registros (Offsets 0, 1 y 2)
+    -- Escritura a registros (Offsets 0 a 16)
+    -- Cada escritura de dato en la RAM (offsets 3 y 5) auto-incrementa
+    -- ram_addr_reg, de modo que una tabla se carga con una sola
+    -- escritura de direccion seguida de escrituras de dato.
     process(clk, reset)
     begin
         if reset = '1' then
@@ -54,19 +137,76 @@ begin
             ctrl_reg     <= (others => '0');
             ram_addr_reg <= (others => '0');
             pow_reg      <= (others => '0');
+            bank_wr_reg  <= (others => '0');
+            bank_play_reg<= (others => '0');
+            bank_req_tgl <= '0';
+            fcw_xfer     <= (others => '0');
+            ctrl_xfer    <= (others => '0');
+            pow_xfer     <= (others => '0');
+            param_req_tgl<= '0';
+            sw_start_reg <= (others => '0');
+            sw_step_reg  <= (others => '0');
+            sw_dwell_reg <= (others => '0');
+            sw_stop_reg  <= (others => '0');
+            sw_ctrl_reg  <= (others => '0');
+            sw_start_xfer<= (others => '0');
+            sw_step_xfer <= (others => '0');
+            sw_dwell_xfer<= (others => '0');
+            sw_stop_xfer <= (others => '0');
+            sw_ctrl_xfer <= (others => '0');
+            sync_req_tgl <= '0';
         elsif rising_edge(clk) then
             if wr_en = '1' then
-                case addr(2 downto 0) is
-                    when "000" => -- Offset 0: Frequency Control Word
+                case addr(4 downto 0) is
+                    when "00000" => -- Offset 0: Frequency Control Word
                         fcw_reg <= unsigned(wr_data);
-                    when "001" => -- Offset 1: Control (Bit 0: Enable, Bit 1: Wave Sel)
-                        ctrl_reg <= wr_data(1 downto 0);
-                    when "010" => -- Offset 2: Direccion de RAM a escribir
+                    when "00001" => -- Offset 1: Control (Bit 0: Enable, Bit 1: Wave Sel, Bit 2: Phase Rst, Bit 3: Sync Wait)
+                        ctrl_reg <= wr_data(3 downto 0);
+                    when "00010" => -- Offset 2: Direccion de RAM a escribir
                         ram_addr_reg <= unsigned(wr_data(PHASE_WIDTH-1 downto 0));
-                    when "011" => -- Offset 3: Dato de RAM (dispara escritura)
-                        null;
-                    when "100" => -- Offset 4: Phase Offset Word
+                    when "00011" => -- Offset 3: Dato de RAM (dispara escritura, addr + 1)
+                        ram_addr_reg <= ram_addr_reg + 1;
+                    when "00100" => -- Offset 4: Phase Offset Word
                         pow_reg <= unsigned(wr_data);
+                    when "00101" => -- Offset 5: Par de datos de RAM empaquetado (addr + 2)
+                        ram_addr_reg <= ram_addr_reg + 2;
+                    when "00110" => -- Offset 6: Banco AWG destino de las escrituras
+                        bank_wr_reg <= unsigned(wr_data(BANK_BITS-1 downto 0));
+                    when "00111" => -- Offset 7: Banco AWG a reproducir (conmuta en el wrap)
+                        -- se ignora si la peticion anterior aun no se ha
+                        -- aplicado (bank_play_reg estable hasta el ack)
+                        if bank_pending = '0' then
+                            bank_play_reg <= unsigned(wr_data(BANK_BITS-1 downto 0));
+                            bank_req_tgl  <= not bank_req_tgl;
+                        end if;
+                    when "01000" => -- Offset 8: COMMIT de FCW/POW/CTRL hacia clk_dds
+                        -- se ignora si el commit anterior aun no se ha aplicado
+                        if param_pending = '0' then
+                            fcw_xfer      <= fcw_reg;
+                            ctrl_xfer     <= ctrl_reg;
+                            pow_xfer      <= pow_reg;
+                            sw_start_xfer <= sw_start_reg;
+                            sw_step_xfer  <= sw_step_reg;
+                            sw_dwell_xfer <= sw_dwell_reg;
+                            sw_stop_xfer  <= sw_stop_reg;
+                            sw_ctrl_xfer  <= sw_ctrl_reg;
+                            param_req_tgl <= not param_req_tgl;
+                            ctrl_reg(2)   <= '0';  -- Phase Rst se auto-borra
+                            ctrl_reg(3)   <= '0';  -- Sync Wait se auto-borra
+                            sw_ctrl_reg(4)<= '0';  -- Sweep Go se auto-borra
+                        end if;
+                    when "01001" => -- Offset 9: Barrido, FCW inicial
+                        sw_start_reg <= unsigned(wr_data);
+                    when "01010" => -- Offset 10: Barrido, incremento de FCW (lineal) o ratio Q0.16 (log)
+                        sw_step_reg <= unsigned(wr_data);
+                    when "01011" => -- Offset 11: Barrido, ciclos de clk_dds por escalon
+                        sw_dwell_reg <= unsigned(wr_data);
+                    when "01100" => -- Offset 12: Barrido, FCW final
+                        sw_stop_reg <= unsigned(wr_data);
+                    when "01101" => -- Offset 13: Barrido, control (0: Run, 2-1: Modo, 3: Log, 4: Go)
+                        sw_ctrl_reg <= wr_data(4 downto 0);
+                    when "01110" => -- Offset 14: SYNC, aplica a la vez los commits armados de todos los canales
+                        sync_req_tgl <= not sync_req_tgl;
                     when others =>
                         null;
                 end case;
@@ -74,16 +214,126 @@ begin
         end if;
     end process;
 
-    -- Generador de pulso de escritura para la RAM (Offset 3)
+    -- Generador de pulso de escritura para la RAM (Offsets 3 y 5)
     -- Cuando el C++ escribe en el Registro 3, dispara este pulso un ciclo de reloj
-    ram_we_pulse <= '1' when wr_en = '1' and addr(2 downto 0) = "011" else '0';
+    -- Registro 5: wr_data(13:0) -> addr, wr_data(29:16) -> addr + 1
+    ram_we_pulse <= '1' when wr_en = '1' and (addr(4 downto 0) = "00011" or addr(4 downto 0) = "00101") else '0';
+    ram_pair     <= '1' when addr(4 downto 0) = "00101" else '0';
+
+    ------------------------------------------------------------------
+    -- CRC32 de las escrituras y del contenido de la RAM AWG
+    ------------------------------------------------------------------
+    -- Offset 15 (W): reinicia crc_wr. Offset 16 (W): recorre el banco
+    -- BANK_WR (TABLE_SIZE/2 lecturas de un par); una escritura del bus
+    -- en la RAM tiene prioridad y retrasa la lectura en curso.
+    crc_sample <= "00" & wr_data(16+DAC_WIDTH-1 downto 16) & "00" & wr_data(DAC_WIDTH-1 downto 0);
+    scan_addr  <= scan_bank & scan_idx;
+
+    process(clk, reset)
+    begin
+        if reset = '1' then
+            crc_wr     <= (others => '1');
+            crc_scan   <= (others => '1');
+            scan_busy  <= '0';
+            scan_run   <= '0';
+            scan_issue <= '0';
+            scan_last  <= '0';
+            scan_idx   <= (others => '0');
+            scan_bank  <= (others => '0');
+        elsif rising_edge(clk) then
+            -- CRC de las muestras escritas (orden de escritura)
+            if wr_en = '1' and addr(4 downto 0) = "01111" then
+                crc_wr <= (others => '1');
+            elsif ram_we_pulse = '1' then
+                if ram_pair = '1' then
+                    crc_wr <= crc32_upd(crc_wr, crc_sample);
+                else
+                    crc_wr <= crc32_upd(crc_wr, crc_sample(15 downto 0));
+                end if;
+            end if;
+
+            -- Recorrido del banco: emitir direccion, consumir el dato al ciclo siguiente
+            scan_issue <= '0';
+            scan_last  <= '0';
+            if wr_en = '1' and addr(4 downto 0) = "10000" then
+                crc_scan  <= (others => '1');
+                scan_bank <= bank_wr_reg;
+                scan_idx  <= (others => '0');
+                scan_busy <= '1';
+                scan_run  <= '1';
+            elsif scan_busy = '1' then
+                if scan_issue = '1' then
+                    crc_scan <= crc32_upd(crc_scan, "00" & scan_odd & "00" & scan_even);
+                    if scan_last = '1' then
+                        scan_busy <= '0';
+                    end if;
+                end if;
+                if scan_run = '1' and ram_we_pulse = '0' then
+                    scan_issue <= '1';
+                    if scan_idx = (scan_idx'range => '1') then
+                        scan_last <= '1';
+                        scan_run  <= '0';
+                    else
+                        scan_idx <= scan_idx + 1;
+                    end if;
+                end if;
+            end if;
+        end if;
+    end process;
+
+    -- Confirmaciones de conmutacion de banco y de commit (clk_dds -> clk)
+    process(clk, reset)
+    begin
+        if reset = '1' then
+            bank_ack_s  <= (others => '0');
+            param_ack_s <= (others => '0');
+            sweep_act_s <= (others => '0');
+        elsif rising_edge(clk) then
+            bank_ack_s  <= bank_ack_s(0) & bank_ack_tgl;
+            param_ack_s <= param_ack_s(0) & param_ack_tgl;
+            sweep_act_s <= sweep_act_s(0) & sweep_active;
+        end if;
+    end process;
+
+    -- Pulso de sincronismo (clk -> clk_dds): un unico sincronizador para
+    -- que todos los canales vean el pulso en el mismo ciclo de clk_dds
+    process(clk_dds, reset)
+    begin
+        if reset = '1' then
+            sync_req_s <= (others => '0');
+        elsif rising_edge(clk_dds) then
+            sync_req_s <= sync_req_s(1 downto 0) & sync_req_tgl;
+        end if;
+    end process;
+
+    sync_out <= sync_req_s(2) xor sync_req_s(1);
+
+    bank_pending  <= bank_req_tgl xor bank_ack_s(1);
+    param_pending <= param_req_tgl xor param_ack_s(1);
 
     ------------------------------------------------------------------
     -- 2. Lectura del Bus MMIO (FPGA -> MicroBlaze)
-    --    Solo devuelve fcw_reg en cualquier direccion.
+    --    Offset 7: STATUS {bank_play(5:4), scan_busy(3), sweep_active(2),
+    --                      update_done(1), bank_pending(0)}
+    --    Offset 15: CRC32 de las muestras escritas
+    --    Offset 16: CRC32 del contenido del banco (valido con scan_busy = 0)
+    --    Resto de offsets: fcw_reg.
     --    ctrl_reg y ram_addr_reg son senales internas (write-only).
     ------------------------------------------------------------------   
-    rd_data <= std_logic_vector(fcw_reg);
+    process(bank_play_reg, bank_pending, param_pending, sweep_act_s, scan_busy)
+    begin
+        status_word <= (others => '0');
+        status_word(0) <= bank_pending;
+        status_word(1) <= not param_pending;  -- ultimo commit aplicado
+        status_word(2) <= sweep_act_s(1);     -- barrido en marcha
+        status_word(3) <= scan_busy;          -- CRC del banco en curso
+        status_word(4+BANK_BITS-1 downto 4) <= std_logic_vector(bank_play_reg);
+    end process;
+
+    rd_data <= status_word       when addr(4 downto 0) = "00111" else
+               not crc_wr        when addr(4 downto 0) = "01111" else
+               not crc_scan      when addr(4 downto 0) = "10000" else
+               std_logic_vector(fcw_reg);
       
 
     ------------------------------------------------------------------
@@ -92,22 +342,50 @@ begin
     dds_awg_unit : entity work.dds_awg_core
         generic map(
             PHASE_WIDTH => PHASE_WIDTH,
-            DAC_WIDTH   => DAC_WIDTH
+            SINE_WIDTH  => SINE_WIDTH,
+            DAC_WIDTH   => DAC_WIDTH,
+            BANK_BITS   => BANK_BITS,
+            LANES       => LANES
         )
         port map(
             clk         => clk_dds,    -- <<< Reloj rapido 165 MHz
             reset       => reset,
             
-            -- Senales de Control
-            fcw          => fcw_reg,
-            phase_offset => pow_reg,
-            enable       => ctrl_reg(0),
-            wave_sel     => ctrl_reg(1),
+            -- Senales de Control (copia estable + handshake de commit)
+            fcw           => fcw_xfer,
+            phase_offset  => pow_xfer,
+            enable        => ctrl_xfer(0),
+            wave_sel      => ctrl_xfer(1),
+            phase_rst     => ctrl_xfer(2),
+            sync_wait     => ctrl_xfer(3),
+            sync_pulse    => sync_in,
+            param_req_tgl => param_req_tgl,
+            param_ack_tgl => param_ack_tgl,
+            
+            -- Barrido de frecuencia
+            sweep_start   => sw_start_xfer,
+            sweep_stop    => sw_stop_xfer,
+            sweep_step    => sw_step_xfer,
+            sweep_dwell   => sw_dwell_xfer,
+            sweep_ctrl    => sw_ctrl_xfer,
+            sweep_active  => sweep_active,
+            
+            -- Interfaz hacia la RAM programable (puerto en el reloj del bus)
+            ram_clk      => clk,
+            ram_we       => ram_we_pulse,
+            ram_bank_in  => bank_wr_reg,
+            ram_pair     => ram_pair,
+            ram_addr_in  => ram_addr_reg,
+            ram_data_in  => wr_data(DAC_WIDTH-1 downto 0), -- El dato llega directo del bus
+            ram_data2_in => wr_data(16+DAC_WIDTH-1 downto 16),
+            scan_addr    => scan_addr,
+            scan_even    => scan_even,
+            scan_odd     => scan_odd,
             
-            -- Interfaz hacia la RAM programable
-            ram_we      => ram_we_pulse,
-            ram_addr_in => ram_addr_reg,
-            ram_data_in => wr_data(DAC_WIDTH-1 downto 0), -- El dato llega directo del bus
+            -- Conmutacion de banco AWG
+            bank_sel     => bank_play_reg,
+            bank_req_tgl => bank_req_tgl,
+            bank_ack_tgl => bank_ack_tgl,
             
             -- Salida
             dac_out     => dac_out